@@ -5,6 +5,13 @@
 #include <ctime>
 #include <sstream> // 1/22/2026 is for this one and the one above
 
+#include <algorithm>
+
+#include "beltnames.h"
+#include "billingledger.h"
+#include "enrolldate.h"
+#include "rankrules.h"
+
 // UNCOMMENT the line below to run Tests. COMMENT it to run the Menu.
 //#define TEST_MODE 
 
@@ -12,17 +19,21 @@ using namespace std;
 
 //define an enum for Belt Ranks
 enum BeltRank { White, Yellow, Green, Blue, Purple, Brown, Black };
+static_assert(beltnames::ranks.size() == Black + 1, "rank names out of step with BeltRank");
+static_assert(rankrules::bandrank[rankrules::bandcount - 1] == Black, "rank rules out of step with BeltRank");
 
 //create a struct that holds all student info
 struct StudentInfo {
     string name = "N/A";
     int age = 0; //will change this later to check if the age is above or equal to 6
     string startDate = "01/22/2026";
+    int32_t startDay = enrolldate::fromcivil(2026, 1, 22); //startDate as a day number
     int monthsEnrolled = 0;
     bool isReturning = false;
     BeltRank rank = White; //use the enum here
-    double balance = 0.0;
+    double balance = 0.0; //what the ledger says is still owed
     bool hasPaidCurrentMonth = false;
+    unsigned int ledgerId = 0; //student number in the billing ledger
 };
 
 
@@ -30,7 +41,8 @@ void Introduction();
 void recommendLevel(StudentInfo& s); //pass Struct by reference to update it
 void calculateSessionCount(StudentInfo& s);
 string getRankName(BeltRank r);
-void managePayments(StudentInfo& s);
+void managePayments(StudentInfo& s, billingledger& ledger);
+int currentLedgerMonth();
 
 int main()
 {
@@ -41,6 +53,8 @@ int main()
     bool hasPaidCurrentMonth = false;
     // create instance for Struct
     StudentInfo currentStudent; //might change the name of the value
+    billingledger ledger; //every charge and payment, newest last
+    unsigned int nextLedgerId = 0; //each registration gets its own ledger row
 
     //present intro
     Introduction();
@@ -76,6 +90,16 @@ int main()
             cout << "Start Date: (ex: (MM / DD / YYYY)) ";
             cin.ignore();
             getline(cin, currentStudent.startDate);
+            currentStudent.startDay = enrolldate::parse(currentStudent.startDate);
+            if (currentStudent.startDay == enrolldate::invalid) {
+                cout << "Invalid date! Using today." << endl;
+                currentStudent.startDay = enrolldate::today();
+                currentStudent.startDate = enrolldate::format(currentStudent.startDay);
+            }
+            // a new registration is a new student as far as billing goes
+            currentStudent.ledgerId = nextLedgerId++;
+            currentStudent.balance = 0.0;
+            currentStudent.hasPaidCurrentMonth = false;
             dataEntered = true;
             cout << "Information recorded successfully!" << endl;
             break;
@@ -120,7 +144,7 @@ int main()
                 // Ensure we have the latest enrollment time
                 calculateSessionCount(currentStudent);
                 // Run the payment system
-                managePayments(currentStudent);
+                managePayments(currentStudent, ledger);
             }
             break;
         case 5:
@@ -151,87 +175,37 @@ void recommendLevel(StudentInfo& s) {
     // 2. Recommend Rank based on monthsEnrolled (calculated in getSessionCount)
     cout << "Analyzing " << s.monthsEnrolled << " months of training..." << endl;
 
-    if (s.monthsEnrolled < 6) {
-        cout << "Recommendation: Beginner (White Belt)." << endl;
-        s.rank = White;
-    }
-    else if (s.monthsEnrolled >= 6 && s.monthsEnrolled < 12) {
-        cout << "Recommendation: Intermediate Beginner (Yellow Belt)." << endl;
-        s.rank = Yellow;
-    }
-    else if (s.monthsEnrolled >= 12 && s.monthsEnrolled < 18){
-        cout << "Recommendation: Intermediate (Green Belt)." << endl;
-        s.rank = Green;
-    }
-    else if (s.monthsEnrolled >= 18 && s.monthsEnrolled < 24) {
-        cout << "Recommendation: Intermediate Pro (Blue Belt)." << endl;
-        s.rank = Blue;
-    }
-    else if (s.monthsEnrolled >= 24 && s.monthsEnrolled < 30) {
-        cout << "Recommendation: Advanced Beginner (Purple Belt)." << endl;
-        s.rank = Purple;
-    }
-    else if (s.monthsEnrolled >= 30 && s.monthsEnrolled < 36) {
-        cout << "Recommendation: Advanced (Brown Belt)." << endl;
-        s.rank = Brown;
-    }
-    else if (s.monthsEnrolled >= 36 && s.monthsEnrolled < 42) {
-        cout << "Recommendation: Candidate for Black Belt testing." << endl;
-        s.rank = Brown;
-    }
-    else if (s.monthsEnrolled >= 42) {
-        cout << "Recommendation: Master." << endl;
-        s.rank = Black;
-    }
+    // one line per six month band, same bands as rankrules
+    static const char* const advice[rankrules::bandcount] = {
+        "Beginner (White Belt).",
+        "Intermediate Beginner (Yellow Belt).",
+        "Intermediate (Green Belt).",
+        "Intermediate Pro (Blue Belt).",
+        "Advanced Beginner (Purple Belt).",
+        "Advanced (Brown Belt).",
+        "Candidate for Black Belt testing.",
+        "Master."
+    };
+    cout << "Recommendation: " << advice[rankrules::bandof(s.monthsEnrolled)] << endl;
+    s.rank = static_cast<BeltRank>(rankrules::placementfor(s.monthsEnrolled).rank);
 }
 
 void calculateSessionCount(StudentInfo& s) {
-    // 1. Get current date safely for 2026
-    time_t t = time(0);
-    struct tm now;
-
-    // Using the 'safe' version for modern debuggers
-    #ifdef _WIN32
-        localtime_s(&now, &t);
-    #else
-        now = *localtime(&t);
-    #endif
-
-    int currentYear = now.tm_year + 1900;
-    int currentMonth = now.tm_mon + 1; // tm_mon is 0-11
-
-    // 2. Parse the date string (MM / DD / YYYY)
-    int startM, startD, startY;
-    char slash1, slash2;
-    stringstream ss(s.startDate);
-
-    if (ss >> startM >> slash1 >> startD >> slash2 >> startY) {
-        int totalMonths = ((currentYear - startY) * 12) + (currentMonth - startM);
-
-        // Update the struct (This requires StudentInfo& s to be a modifiable lvalue)
-        if (totalMonths < 0) {
-            s.monthsEnrolled = 0;
-        }
-        else {
-            s.monthsEnrolled = totalMonths;
-        }
-    }
+    // start date was parsed once at registration, this is just month math
+    enrolldate::monthsenrolled(&s.startDay, &s.monthsEnrolled, 1, enrolldate::today());
 }
 
 string getRankName(BeltRank r) {
-    switch (r) {
-    case White:  return "White";
-    case Yellow: return "Yellow";
-    case Green:  return "Green";
-    case Blue:   return "Blue";
-    case Purple: return "Purple";
-    case Brown:  return "Brown";
-    case Black:  return "Black";
-    default:     return "White";
-    }
+    return string(beltnames::ranks.name(r, "White"));
 }
 
-void managePayments(StudentInfo& s) {
+int currentLedgerMonth() {
+    int year, month, day;
+    enrolldate::tocivil(enrolldate::today(), year, month, day);
+    return billingledger::monthof(year, month);
+}
+
+void managePayments(StudentInfo& s, billingledger& ledger) {
     double monthlyRate;
 
     // 1. Determine rate based on Age (Youth vs Adult)
@@ -244,23 +218,38 @@ void managePayments(StudentInfo& s) {
         cout << "Class Type: Adult (2-3 sessions/week)" << endl;
     }
 
-    // 2. Calculate Lifetime Investment (Total months * rate)
-    s.balance = s.monthsEnrolled * monthlyRate;
+    // 2. Charge every month since they started that the ledger hasn't billed yet,
+    // monthsEnrolled months in all ending with this one: [start, thisMonth + 1)
+    int thisMonth = currentLedgerMonth();
+    int endMonth = thisMonth + 1;
+    int firstUnbilled = max(ledger.student(s.ledgerId).lastcharge + 1, endMonth - s.monthsEnrolled);
+    for (int m = firstUnbilled; m < endMonth; m++) {
+        ledger.charge(s.ledgerId, m, billingledger::centsof(monthlyRate));
+    }
 
     cout << "Monthly Rate: $" << fixed << setprecision(2) << monthlyRate << endl;
-    cout << "Total Tuition over " << s.monthsEnrolled << " months: $" << s.balance << endl;
-
-    // 3. Check current month status
-    char paidChar;
-    cout << "Has the current month (January 2026) been paid? (y/n): ";
-    cin >> paidChar;
+    cout << "Total Tuition billed since " << s.startDate << ": $" << ledger.student(s.ledgerId).charged / 100.0 << endl;
 
-    if (paidChar == 'y' || paidChar == 'Y') {
+    // 3. Check current month status, straight from the ledger totals (unpaid older months included)
+    int64_t due = ledger.due(s.ledgerId, thisMonth);
+    if (due <= 0) {
         s.hasPaidCurrentMonth = true;
-        cout << "Payment recorded. Thank you!" << endl;
+        cout << "The current month is already paid." << endl;
     }
     else {
-        s.hasPaidCurrentMonth = false;
-        cout << "Balance Due: $" << monthlyRate << " for the current session." << endl;
+        char paidChar;
+        cout << "Has the current month (January 2026) been paid? (y/n): ";
+        cin >> paidChar;
+
+        if (paidChar == 'y' || paidChar == 'Y') {
+            ledger.pay(s.ledgerId, thisMonth, due);
+            s.hasPaidCurrentMonth = true;
+            cout << "Payment recorded. Thank you!" << endl;
+        }
+        else {
+            s.hasPaidCurrentMonth = false;
+            cout << "Balance Due: $" << due / 100.0 << " for the current session." << endl;
+        }
     }
+    s.balance = ledger.student(s.ledgerId).balance() / 100.0;
 }
@@ -1,13 +1,24 @@
 #include "DojoManager.h"
+#include "enrolldate.h"
 #include <iostream>
+#include <algorithm>
+#include <thread>
+#include <sstream>
 using namespace std;
 
-DojoManager::DojoManager() : student_arr()
+DojoManager::DojoManager() : student_arr(), nameindex(), namelookup(), pending(nullptr), pendingname(), valuesum(0.0), listeners(), nextid(1)
 {
 }
 
 DojoManager::~DojoManager()
 {
+	//going away isn't a change anyone should record, but whoever is
+	//listening has to stop holding on to the roster
+	vector<rosterlistener*> leaving;
+	leaving.swap(listeners);
+	for (size_t i = 0; i < leaving.size(); ++i) {
+		leaving[i]->detached();
+	}
 	clear();
 }
 
@@ -32,7 +43,13 @@ bool DojoManager::remove(int index) {
 	return getsize() != oldsize;
 }
 void DojoManager::clear() {
+	for (size_t i = 0; i < listeners.size(); ++i) {
+		listeners[i]->cleared();
+	}
+	nameindex.clear();
+	namelookup.clear();
 	student_arr.clear(true);
+	valuesum = 0.0;
 }
 
 StudentInfo* DojoManager::getind(int index) const {
@@ -46,11 +63,34 @@ StudentInfo* DojoManager::operator[](int index) const {
 	return getind(index);
 }
 
+unsigned int DojoManager::getnextid() const {
+	return nextid;
+}
+
+void DojoManager::reserveids(unsigned int next) {
+	if (next > nextid) {
+		nextid = next;
+	}
+}
+
 DojoManager& DojoManager::operator+=(StudentInfo* ptr) {
 	if (!ptr) {
 		return *this;
 	}
+	//students that already have an id (loaded from a save) keep it
+	if (ptr->getid() == 0) {
+		ptr->setid(nextid++);
+	}
+	else if (ptr->getid() >= nextid) {
+		nextid = ptr->getid() + 1;
+	}
 	student_arr.push_back(ptr);
+	ptr->setwatcher(this);
+	indexname(student_arr.handleat(getsize() - 1));
+	valuesum += ptr->getvalue();
+	for (size_t i = 0; i < listeners.size(); ++i) {
+		listeners[i]->added(getsize() - 1, ptr);
+	}
 	return *this;
 }
 
@@ -58,119 +98,273 @@ DojoManager& DojoManager::operator-=(int index) {
 	if (index < 0 || index >= getsize()) {
 		throw exceptionhandler("Index out of bounds (DojoManager::operator-=)");
 	}
+	StudentList::handle h = student_arr.handleat(index);
+	for (size_t i = 0; i < listeners.size(); ++i) {
+		listeners[i]->removing(index, student_arr.get(h));
+	}
+	unindexname(h, nameof(h));
+	const double value = valueof(h);
 	if (!student_arr.remove_at(index, true)) {
 		throw exceptionhandler("Index out of bounds (DojoManager::operator-=)");
 	}
+	valuesum -= value;
+	if (getsize() == 0) {
+		valuesum = 0.0; //drop any rounding left over
+	}
 	return *this;
 }
 
 void DojoManager::printall() const {
-	int i = 0;
+	printall(0);
+}
+
+void DojoManager::printall(int threads) const {
+	const int n = getsize();
+	const int shardrows = 4096;
+	if (threads <= 0) {
+		threads = static_cast<int>(thread::hardware_concurrency());
+	}
+	if (threads <= 1 || n <= shardrows) {
+		for (int i = 0; i < n; ++i) {
+			StudentInfo* cur = student_arr.at(i);
+			if (cur) {
+				cout << i << ". Student value: " << cur->getvalue() << '\n';
+				cur->printto(cout);
+			}
+		}
+		cout.flush();
+		return;
+	}
 
-	for (StudentList::iterator it = student_arr.begin(); it.hascurrent(); it.next(), ++i) {
-		if (it.data()) {
-			cout << i << ". Student value: " << it.data()->getvalue() << endl;
-			it.data()->print();
+	//one wave = one shard per thread, each into its own stream set up like
+	//cout (precision etc.), then the text goes out in roster order
+	vector<string> shards(threads);
+	for (int first = 0; first < n; first += threads * shardrows) {
+		vector<thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			const int begin = first + t * shardrows;
+			const int end = min(n, begin + shardrows);
+			shards[t].clear();
+			if (begin >= end) {
+				continue;
+			}
+			workers.push_back(thread([this, &shards, t, begin, end]() {
+				ostringstream out;
+				out.copyfmt(cout);
+				for (int i = begin; i < end; ++i) {
+					StudentInfo* cur = student_arr.at(i);
+					if (cur) {
+						out << i << ". Student value: " << cur->getvalue() << '\n';
+						cur->printto(out);
+					}
+				}
+				shards[t] = out.str();
+			}));
+		}
+		for (size_t w = 0; w < workers.size(); ++w) {
+			workers[w].join();
+		}
+		for (int t = 0; t < threads; ++t) {
+			cout.write(shards[t].data(), static_cast<streamsize>(shards[t].size()));
 		}
 	}
+	cout.flush();
 }
 
 int DojoManager::seqsearch(const string& name) const {
-	for (int i = 0; i < getsize(); ++i) {
-		if (student_arr.at(i) && student_arr.at(i)->getName() == name) {
-			return i;
+	//same answer as the old front to back scan: the first match in the roster
+	int found = -1;
+	pair<namemap::const_iterator, namemap::const_iterator> range = namelookup.equal_range(name);
+	for (; range.first != range.second; ++range.first) {
+		const int index = student_arr.indexof(range.first->second);
+		if (found < 0 || index < found) {
+			found = index;
 		}
 	}
-	return -1;
+	return found;
 }
 
-void DojoManager::bubblesort() {
-	const int n = getsize();
-	if (n <= 1) {
-		return;
+void DojoManager::sort(const studentorder& order) {
+	student_arr.sort(order);
+	for (size_t i = 0; i < listeners.size(); ++i) {
+		listeners[i]->sorted(order);
 	}
-	for (int pass = 0; pass < n - 1; ++pass) {
-		bool swapped = false;
-		for (int i = 0; i < n - 1 - pass; ++i) {
-			string left;
-			if (student_arr.at(i)) {
-				left = student_arr.at(i)->getName();
-			}
-			else {
-				left = "";
-			}
-			string right;
-			if (student_arr.at(i + 1)) {
-				right = student_arr.at(i + 1)->getName();
-			}
-			else {
-				right = "";
-			}
-			if (left > right) {
-				StudentList::iterator it = student_arr.begin();
-				for (int k = 0; k < i; ++k) it.next();
-				StudentInfo*& a = it.data();
-				it.next();
-				StudentInfo*& b = it.data();
-
-				StudentInfo* tmp = a;
-				a = b;
-				b = tmp;
-
-				swapped = true;
-			}
-		}
-		if (!swapped) {
-			break;
+}
+
+//kept for the menu and old callers, name order is just one studentorder now
+void DojoManager::bubblesort() {
+	sort(studentorder(studentorder::fullname));
+}
+
+int DojoManager::binsearch(const string& name) {
+	//first equal name in the tree, then the earliest of the duplicates in
+	//the roster, so it agrees with seqsearch and rosterview whatever order
+	//they were added or sorted in
+	int found = -1;
+	for (nameorder::const_iterator pos = nameindex.lower_bound(name); pos != nameindex.end() && pos->first == name; ++pos) {
+		const int index = student_arr.indexof(pos->second);
+		if (found < 0 || index < found) {
+			found = index;
 		}
 	}
+	return found;
 }
 
-int DojoManager::binsearch(const string& name) {
-	bubblesort();
-	int low = 0;
-	int high = getsize() - 1;
-	while (low <= high) {
-		const int mid = low + (high - low) / 2;
-		string midname;
-		if (student_arr.at(mid)) {
-			midname = student_arr.at(mid)->getName();
+const string& DojoManager::nameof(StudentList::handle h) const {
+	static const string empty;
+	StudentInfo* cur = student_arr.get(h);
+	if (cur) {
+		return cur->getName();
+	}
+	return empty;
+}
+
+void DojoManager::indexname(StudentList::handle h) {
+	const string& name = nameof(h);
+	nameindex.insert(make_pair(name, h));
+	namelookup.insert(make_pair(name, h));
+}
+
+//name is where h was filed, h itself may already carry a new name
+void DojoManager::unindexname(StudentList::handle h, const string& name) {
+	pair<nameorder::iterator, nameorder::iterator> sorted = nameindex.equal_range(name);
+	for (; sorted.first != sorted.second; ++sorted.first) {
+		if (sorted.first->second == h) {
+			nameindex.erase(sorted.first);
+			break;
 		}
-		else {
-			midname = "";
+	}
+	pair<namemap::iterator, namemap::iterator> range = namelookup.equal_range(name);
+	for (; range.first != range.second; ++range.first) {
+		if (range.first->second == h) {
+			namelookup.erase(range.first);
+			return;
 		}
-		if (midname == name) {
-			return mid;
+	}
+}
+
+StudentList::handle DojoManager::findhandle(StudentInfo* ptr) const {
+	if (!ptr) {
+		return nullptr;
+	}
+	pair<namemap::const_iterator, namemap::const_iterator> range = namelookup.equal_range(ptr->getName());
+	for (; range.first != range.second; ++range.first) {
+		if (student_arr.get(range.first->second) == ptr) {
+			return range.first->second;
 		}
-		if (midname < name) {
-			low = mid + 1;
+	}
+	return nullptr;
+}
+
+void DojoManager::beforechange(StudentInfo* ptr) {
+	pending = findhandle(ptr);
+	if (pending) {
+		pendingname = ptr->getName();
+		valuesum -= ptr->getvalue();
+	}
+}
+
+void DojoManager::afterchange(StudentInfo* ptr) {
+	if (pending && student_arr.get(pending) == ptr) {
+		//only a rename moves the student in the name indexes
+		if (ptr->getName() != pendingname) {
+			unindexname(pending, pendingname);
+			indexname(pending);
 		}
-		else {
-			high = mid - 1;
+		valuesum += ptr->getvalue();
+		for (size_t i = 0; i < listeners.size(); ++i) {
+			listeners[i]->changed(student_arr.indexof(pending), ptr);
 		}
 	}
-	return -1;
+	pending = nullptr;
+}
+
+void DojoManager::addlistener(rosterlistener* listener) {
+	if (listener && std::find(listeners.begin(), listeners.end(), listener) == listeners.end()) {
+		listeners.push_back(listener);
+	}
+}
+
+void DojoManager::removelistener(rosterlistener* listener) {
+	listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
 }
 
 double DojoManager::totalvalue() const {
-	return totalvalue_rec(0);
+	return valuesum;
 }
 
-double DojoManager::totalvalue_rec(StudentList::iterator it) const
-{
-	if (!it.hascurrent()) {
-		return 0.0;
+double DojoManager::valueof(StudentList::handle h) const {
+	StudentInfo* cur = student_arr.get(h);
+	if (cur) {
+		return cur->getvalue();
 	}
+	return 0.0;
+}
 
-	StudentInfo* cur = it.data();
-	double current = 0.0;
-	if (cur) {
-		current = cur->getvalue();
+double DojoManager::recomputevalue(int threads) const {
+	const int n = getsize();
+	if (threads <= 0) {
+		threads = static_cast<int>(thread::hardware_concurrency());
 	}
-	else {
-		current = 0.0;
+	if (threads <= 1 || n < 10000) {
+		threads = 1;
 	}
 
-	it.next();
-	return current + totalvalue_rec(it);
-}
\ No newline at end of file
+	vector<double> partial(threads, 0.0);
+	vector<thread> workers;
+	const int chunk = (n + threads - 1) / threads;
+	for (int t = 0; t < threads; ++t) {
+		const int first = t * chunk;
+		const int last = min(n, first + chunk);
+		workers.push_back(thread([this, &partial, t, first, last]() {
+			double sum = 0.0;
+			for (int i = first; i < last; ++i) {
+				StudentInfo* cur = student_arr.at(i);
+				if (cur) {
+					sum += cur->getvalue();
+				}
+			}
+			partial[t] = sum;
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+
+	double total = 0.0;
+	for (int t = 0; t < threads; ++t) {
+		total += partial[t];
+	}
+	return total;
+}
+
+int DojoManager::refreshmonths() {
+	return refreshmonths(enrolldate::today());
+}
+
+int DojoManager::refreshmonths(int32_t now) {
+	//start days go through the batch month math a block at a time, setters
+	//only for real changes so listeners see just those
+	const int blockrows = 4096;
+	vector<int32_t> starts(blockrows);
+	vector<int> months(blockrows);
+	int changed = 0;
+	const int n = getsize();
+	for (int first = 0; first < n; first += blockrows) {
+		const int count = std::min(blockrows, n - first);
+		for (int i = 0; i < count; ++i) {
+			const StudentInfo* cur = student_arr.at(first + i);
+			starts[i] = cur->getStartDay();
+			months[i] = cur->getMonths();
+		}
+		enrolldate::monthsenrolled(starts.data(), months.data(), static_cast<size_t>(count), now);
+		for (int i = 0; i < count; ++i) {
+			StudentInfo* cur = student_arr.at(first + i);
+			if (cur->getMonths() != months[i]) {
+				cur->setMonths(months[i]);
+				++changed;
+			}
+		}
+	}
+	return changed;
+}
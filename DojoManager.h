@@ -3,10 +3,31 @@
 #include"exceptionhandler.h"
 #include"StudentList.h"
 #include<vector>
+#include<unordered_map>
+#include<map>
 #include"dynamic.h"
+#include"studentorder.h"
+#include"namehash.h"
 #include<string>
 using namespace std;
-class DojoManager
+
+//told about every roster change once it has happened (removals just before),
+//ex: the write-ahead log. indexes are positions in the roster at that moment.
+//a roster destroyed first calls detached() instead, after which the listener
+//must not touch it
+class rosterlistener
+{
+public:
+	virtual ~rosterlistener() {}
+	virtual void added(int, const StudentInfo*) = 0;
+	virtual void removing(int, const StudentInfo*) = 0;
+	virtual void changed(int, const StudentInfo*) = 0;
+	virtual void sorted(const studentorder&) = 0;
+	virtual void cleared() = 0;
+	virtual void detached() {}
+};
+
+class DojoManager : private studentwatcher
 {
 public:
 	DojoManager();
@@ -21,18 +42,61 @@ public:
 
 	StudentInfo* getind(int) const;
 	void printall() const;
+	//shards formatted on worker threads, printed in order, 0 = one per core
+	void printall(int) const;
 
 	StudentInfo* operator[](int) const;
 	DojoManager& operator+=(StudentInfo*);
 	DojoManager& operator-=(int);
 
 	double totalvalue() const;
+	//sums getvalue() from scratch on worker threads, 0 threads = one per core
+	double recomputevalue(int = 0) const;
 
 	int seqsearch(const string&) const;
+	void sort(const studentorder&);
 	void bubblesort();
 	int binsearch(const string&);
+
+	void addlistener(rosterlistener*);
+	void removelistener(rosterlistener*);
+
+	//ids are never handed out twice, not even after the highest one is
+	//removed, so saves keep getnextid() and loads give it back to reserveids
+	unsigned int getnextid() const;
+	//raises the next id to at least the given one, never lowers it
+	void reserveids(unsigned int);
+
+	//nightly: months enrolled from each student's start day, against one
+	//clock reading (or the given day number) for the whole roster. students
+	//without a start day keep their months. returns how many changed
+	int refreshmonths();
+	int refreshmonths(int32_t);
 private:
 	StudentList student_arr;
+	//roster entries ordered by name, kept in step by += and -= so binsearch
+	//never has to touch the physical order. a tree keyed by a copy of the
+	//name, so add, rename and remove are O(log n) and bulk loads stay
+	//O(n log n); a sorted vector here made every insert O(n)
+	typedef multimap<string, StudentList::handle> nameorder;
+	nameorder nameindex;
+	//exact name lookups for seqsearch, same entries as nameindex
+	typedef unordered_multimap<string, StudentList::handle, namehash> namemap;
+	namemap namelookup;
+	StudentList::handle pending;
+	string pendingname;
+	//running getvalue() total, adjusted on every add, remove and setter
+	double valuesum;
+	vector<rosterlistener*> listeners;
+	unsigned int nextid; //next StudentInfo id to hand out
+
+	double valueof(StudentList::handle) const;
+
+	const string& nameof(StudentList::handle) const;
+	void indexname(StudentList::handle);
+	void unindexname(StudentList::handle, const string&);
+	StudentList::handle findhandle(StudentInfo*) const;
 
-	double totalvalue_rec(StudentList::iterator) const;
+	virtual void beforechange(StudentInfo*) override;
+	virtual void afterchange(StudentInfo*) override;
 };
\ No newline at end of file
@@ -1,45 +1,69 @@
 #include "FinancialSystem.h"
+#include "DojoManager.h"
 #include <cstdlib>
 
-double FinancialSystem::pricegen(int age, string gear) {
-    //if age is under 16, they are a minor
-
+double FinancialSystem::pricegen(int age, const string& gear) {
     //if they said yes to needing gear, add gear to amount
-    double StudentPrice;
-    double youthStudentPrice;
-    double adultStudentPrice;
-    double unknownStudentPrice;
-    double gearPrice = 125.0;
-
-    if (age <= 16 && age > 6) //youth student age range
-    {
-        youthStudentPrice = 80.0;
-        if (gear == "y" || gear == "yes" || gear == "Y" || gear == "Yes")
-        {
-            StudentPrice = youthStudentPrice + gearPrice;
-        }
-        else {
-            StudentPrice = youthStudentPrice;
-        }
+    const bool wantsgear = gear == "y" || gear == "yes" || gear == "Y" || gear == "Yes";
+    return priceof(age, wantsgear);
+}
+
+namespace {
+    constexpr double youthStudentPrice = 80.0;
+    constexpr double adultStudentPrice = 120.0;
+    constexpr double gearPrice = 125.0;
+
+    //an unknown age isn't charged for class or gear
+    constexpr double bracketprice(int age, bool gear) {
+        return FinancialSystem::bracketof(age) == FinancialSystem::youth ? youthStudentPrice + (gear ? gearPrice : 0.0)
+            : FinancialSystem::bracketof(age) == FinancialSystem::adult ? adultStudentPrice + (gear ? gearPrice : 0.0)
+            : 0.0;
     }
-    else if (age > 17 && age <= 90) //adult student age range
-    {
-        adultStudentPrice = 120.0;
-        if (gear == "y" || gear == "yes" || gear == "Y" || gear == "Yes")
-        {
-            StudentPrice = adultStudentPrice + gearPrice;
-        }
-        else {
-            StudentPrice = adultStudentPrice;
+
+    struct pricegrid {
+        double slot[FinancialSystem::tableslots];
+    };
+
+    constexpr pricegrid makeprices() {
+        pricegrid grid = {};
+        for (int age = 0; age < FinancialSystem::tableages; ++age) {
+            grid.slot[FinancialSystem::slotof(age, false)] = bracketprice(age, false);
+            grid.slot[FinancialSystem::slotof(age, true)] = bracketprice(age, true);
         }
+        return grid;
     }
-    else {
-        unknownStudentPrice = 0.0;
-        gearPrice = 0.0;
-        StudentPrice = gearPrice + unknownStudentPrice;
-        //print age is wrong, gear price doesnt go into affect
+
+    constexpr pricegrid pricetable = makeprices();
+    static_assert(FinancialSystem::bracketof(FinancialSystem::tableages - 1) == FinancialSystem::unknownage,
+        "ages past the table share its last row, so that row has to be unpriced");
+}
+
+double FinancialSystem::priceof(int age, bool gear) {
+    return pricetable.slot[slotof(age, gear)];
+}
+
+void FinancialSystem::pricebatch(const int32_t* ages, const uint8_t* needsgear, double* prices, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        prices[i] = pricetable.slot[slotof(ages[i], needsgear[i] != 0)];
+    }
+}
+
+void FinancialSystem::pricebatch(const DojoManager& roster, vector<double>& prices) {
+    //pulled into packed blocks first so the pricing loop stays a straight table walk
+    const int blockrows = 4096;
+    int32_t ages[blockrows];
+    uint8_t gear[blockrows];
+    const int n = roster.getsize();
+    prices.resize(n);
+    for (int first = 0; first < n; first += blockrows) {
+        const int count = n - first < blockrows ? n - first : blockrows;
+        for (int i = 0; i < count; ++i) {
+            const StudentInfo* cur = roster.getind(first + i);
+            ages[i] = cur ? cur->getAge() : 0;
+            gear[i] = cur && cur->getGear() ? 1 : 0;
+        }
+        pricebatch(ages, gear, prices.data() + first, static_cast<size_t>(count));
     }
-    return StudentPrice;
 }
 
 // --- FinancialRecord ---
@@ -1,8 +1,37 @@
 //pricing for gear and classes (based off of their age range
 #pragma once
 #include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 using namespace std;
+class DojoManager;
+
 class FinancialSystem
 {
-public: double pricegen(int, string);
-};
\ No newline at end of file
+public: double pricegen(int, const string&);
+
+	//the price groups pricegen charges by (17 and 91+ are not priced)
+	enum agebracket { unknownage, youth, adult };
+	static constexpr agebracket bracketof(int age) {
+		return (age <= 16 && age > 6) ? youth : (age > 17 && age <= 90) ? adult : unknownage;
+	}
+
+	//same price as pricegen with the gear answer already a yes/no
+	static double priceof(int, bool);
+
+	//month-end billing: prices[i] = priceof(ages[i], needsgear[i] != 0), no
+	//branches per student. packed columns, ex: rostercolumns::ages() and needsgear()
+	static void pricebatch(const int32_t*, const uint8_t*, double*, size_t);
+	//one price per roster index
+	static void pricebatch(const DojoManager&, vector<double>&);
+
+	//price table layout, one slot per (age, gear) pair. negative ages and
+	//ages past the end land on the last row, which is unpriced
+	static const int tableages = 128;
+	static const int tableslots = tableages * 2;
+	static constexpr int slotof(int age, bool gear) {
+		return static_cast<int>(((static_cast<unsigned>(age) < tableages ? static_cast<unsigned>(age) : tableages - 1u) << 1)
+			| (gear ? 1u : 0u));
+	}
+};
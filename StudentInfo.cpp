@@ -1,16 +1,18 @@
 #include "StudentInfo.h"
+#include "beltnames.h"
+#include "enrolldate.h"
 #include <iostream>
 #include <string>
 using namespace std;
 
 StudentInfo::StudentInfo():Name(""), Age(6), IsReturning(false),
-MonthsEnrolled(0), Rank(White), Stripes(zero), NeedsGear(false), ECon("") {
+MonthsEnrolled(0), Rank(White), Stripes(zero), NeedsGear(false), ECon(""), StartDay(enrolldate::invalid), watcher(nullptr), Id(0) {
 
 }
 StudentInfo::StudentInfo(const string& name, int age, bool isReturning,
 	int monthsEnrolled, BeltRank rank, BeltStripes stripes, bool needsGear, const string& contact) 
 	: Name(name), Age(age), IsReturning(isReturning),
-	MonthsEnrolled(monthsEnrolled), Rank(rank), Stripes(stripes), NeedsGear(needsGear), ECon(contact) {
+	MonthsEnrolled(monthsEnrolled), Rank(rank), Stripes(stripes), NeedsGear(needsGear), ECon(contact), StartDay(enrolldate::invalid), watcher(nullptr), Id(0) {
 
 }
 
@@ -19,104 +21,139 @@ StudentInfo::~StudentInfo() {
 }
 
 void StudentInfo::setName(const string& name) {
+	changing();
 	Name = name;
+	changed();
 }
 const string& StudentInfo::getName() const {
 	return Name;
 }
 
 void StudentInfo::setAge(int age) {
+	changing();
 	Age = age;
+	changed();
 }
 int StudentInfo::getAge() const {
 	return Age;
 }
 
 void StudentInfo::setMonths(int monthsEnrolled) {
+	changing();
 	MonthsEnrolled = monthsEnrolled;
+	changed();
 }
 int StudentInfo::getMonths() const {
 	return MonthsEnrolled;
 }
 
 void StudentInfo::setReturning(bool isReturning) {
+	changing();
 	IsReturning = isReturning;
+	changed();
 }
 bool StudentInfo::getReturning() const {
 	return IsReturning;
 }
 
 void StudentInfo::setRank(BeltRank rank) {
+	changing();
 	Rank = rank;
+	changed();
 }
 StudentInfo::BeltRank StudentInfo::getRank() const {
 	return Rank;
 }
 
 void StudentInfo::setStripes(BeltStripes stripes) {
+	changing();
 	Stripes = stripes;
+	changed();
 }
 StudentInfo::BeltStripes StudentInfo::getStripes() const {
 	return Stripes;
 }
 
 void StudentInfo::setGear(bool needGear) {
+	changing();
 	NeedsGear = needGear;
+	changed();
 }
 bool StudentInfo::getGear() const {
 	return NeedsGear;
 }
 
 void StudentInfo::setContact(const string& econtact) {
+	changing();
 	ECon = econtact;
+	changed();
 }
 const string& StudentInfo::getContact() const {
 	return ECon;
 }
 
+void StudentInfo::setStartDay(int32_t day) {
+	changing();
+	StartDay = day;
+	changed();
+}
+int32_t StudentInfo::getStartDay() const {
+	return StartDay;
+}
+
+void StudentInfo::setwatcher(studentwatcher* w) {
+	watcher = w;
+}
+studentwatcher* StudentInfo::getwatcher() const {
+	return watcher;
+}
+
+void StudentInfo::setid(unsigned int id) {
+	Id = id;
+}
+unsigned int StudentInfo::getid() const {
+	return Id;
+}
+
+void StudentInfo::changing() {
+	if (watcher) {
+		watcher->beforechange(this);
+	}
+}
+void StudentInfo::changed() {
+	if (watcher) {
+		watcher->afterchange(this);
+	}
+}
+
+//the name tables have to line up with the enums, checked at compile time
+static_assert(beltnames::ranks.size() == StudentInfo::Black + 1, "rank names out of step with BeltRank");
+static_assert(beltnames::stripes.size() == StudentInfo::four + 1, "stripe names out of step with BeltStripes");
+static_assert(beltnames::ranks.parse("Black") == StudentInfo::Black, "rank names out of order");
+static_assert(beltnames::stripes.parse("Four") == StudentInfo::four, "stripe names out of order");
+
 const char* StudentInfo::BeltRankstring(BeltRank r) {
-	if (r == White)
-		return "White";
-	else if (r == Yellow)
-		return "Yellow";
-	else if (r == Green)
-		return "Green";
-	else if (r == Blue)
-		return "Blue";
-	else if (r == Purple)
-		return "Purple";
-	else if (r == Brown)
-		return "Brown";
-	else if (r == Black)
-		return "Black";
-	else
-		return "White";
+	return beltnames::ranks.cname(r, "White");
 }
 
 const char* StudentInfo::BeltStripesstring(BeltStripes s) {
-	if (s == zero)
-		return "Zero";
-	else if (s == one)
-		return "One";
-	else if (s == two)
-		return "Two";
-	else if (s == three)
-		return "Three";
-	else if (s == four)
-		return "Four";
-	else
-		return "Zero";
+	return beltnames::stripes.cname(s, "Zero");
 }
 
 void StudentInfo::print() const {
-	cout << "Name: " << Name << endl;
-	cout << "Age: " << Age << endl;
-	cout << "Returning Student? y/n: " << IsReturning << endl;
-	cout << "Months Enrolled for: " << MonthsEnrolled << endl;
-	cout << "Belt Rank: " << Rank << endl;
-	cout << "Belt Stripes: " << Stripes << endl;
-	cout << "Need Gear? y/n: " << NeedsGear << endl;
-	cout << "Emergency Contact: " << ECon << endl;
+	printto(cout);
+	cout.flush();
+}
+
+void StudentInfo::printto(ostream& output) const {
+	output << "Name: " << Name << '\n';
+	output << "Age: " << Age << '\n';
+	output << "Returning Student? y/n: " << IsReturning << '\n';
+	output << "Months Enrolled for: " << MonthsEnrolled << '\n';
+	output << "Belt Rank: " << Rank << '\n';
+	output << "Belt Stripes: " << Stripes << '\n';
+	output << "Need Gear? y/n: " << NeedsGear << '\n';
+	output << "Emergency Contact: " << ECon << '\n';
 }
 
 void StudentInfo::toStream(ostream& output) const {
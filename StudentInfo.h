@@ -1,8 +1,20 @@
 #pragma once
 #include <string>
+#include <cstdint>
 
 using namespace std;
 
+class StudentInfo;
+
+//anything that indexes students by their fields (DojoManager) gets told
+//before and after a setter changes one, so it can re-file the student
+class studentwatcher {
+public:
+	virtual ~studentwatcher() {}
+	virtual void beforechange(StudentInfo*) = 0;
+	virtual void afterchange(StudentInfo*) = 0;
+};
+
 class StudentInfo {
 public:
 	enum BeltRank //skill of student
@@ -83,7 +95,23 @@ public:
 	void setContact(const string&);
 	const string& getContact() const;
 
+	//enrolldate day number the student started on, enrolldate::invalid if
+	//not known; DojoManager::refreshmonths turns it into months enrolled
+	void setStartDay(int32_t);
+	int32_t getStartDay() const;
+
+	void setwatcher(studentwatcher*);
+	studentwatcher* getwatcher() const;
+
+	//stable id DojoManager hands out on +=, 0 until then. survives sorts,
+	//removals of others and saves; not a field change, watchers aren't told
+	void setid(unsigned int);
+	unsigned int getid() const;
+
+	//forwards to printto(cout), so subclasses override printto and both
+	//print() and DojoManager::printall show their version
 	virtual void print() const;
+	virtual void printto(ostream&) const;
 
 	virtual void toStream(ostream&) const;
 	virtual double getvalue() const = 0;
@@ -94,14 +122,20 @@ public:
 		string Name; //change to first and last name when you have the mental cap
 		static const char* BeltRankstring(BeltRank);
 		static const char* BeltStripesstring(BeltStripes);
+		//wrap every field change (derived setters too) so the watcher sees it
+		void changing();
+		void changed();
 	private:
 		int Age;
 		bool IsReturning;
 		//double Balance;
 		bool NeedsGear;
 		string ECon;
+		int32_t StartDay;
 		BeltRank Rank;
 		BeltStripes Stripes;
+		studentwatcher* watcher;
+		unsigned int Id;
 
 };
 
@@ -1,9 +1,10 @@
 #include "StudentList.h"
 #include "StudentInfo.h"
+#include "studentorder.h"
 #include <iostream>
 using namespace std;
 
-StudentList::node::node(StudentInfo* d, node* n) : data(d), next(n)
+StudentList::node::node(StudentInfo* d, node* n) : data(d), next(n), pos(0)
 {
 }
 
@@ -31,7 +32,7 @@ StudentInfo*& StudentList::iterator::data() const
 	return current->data;
 }
 
-StudentList::StudentList() : head(nullptr), tail(nullptr), sized(0)
+StudentList::StudentList() : head(nullptr), tail(nullptr), sized(0), front(0), origin(0), blocks(), pool()
 {
 }
 
@@ -40,11 +41,99 @@ StudentList::~StudentList()
 	clear(false);
 }
 
+StudentList::node*& StudentList::slot(int index) const
+{
+	int p = origin + front + index;
+	return blocks[p >> blockbits][p & (blocksize - 1)];
+}
+
+void StudentList::reserveslot()
+{
+	if (origin + front + sized >= static_cast<int>(blocks.size()) * blocksize) {
+		blocks.push_back(new node*[blocksize]);
+	}
+}
+
+void StudentList::reservefront()
+{
+	if (origin + front > 0) {
+		return;
+	}
+
+	//room in front for as many students as there are now, so a run of
+	//push_front stays amortized O(1). only the block pointers move, nodes
+	//keep their pos
+	const size_t grow = static_cast<size_t>(sized >> blockbits) + 1;
+	blocks.insert(blocks.begin(), grow, nullptr);
+	for (size_t b = 0; b < grow; ++b) {
+		blocks[b] = new node*[blocksize];
+	}
+	origin += static_cast<int>(grow) * blocksize;
+}
+
+//removals walk the live slots along the table, FIFO churn one way and
+//push_front with removals at the back the other. whole blocks left behind
+//at either end are freed, keeping one spare on each side for the next push
+void StudentList::trimslots()
+{
+	const int spare = (origin + front) >> blockbits;
+	if (spare > 1) {
+		const int drop = spare - 1;
+		for (int b = 0; b < drop; ++b) {
+			delete[] blocks[b];
+		}
+		blocks.erase(blocks.begin(), blocks.begin() + drop);
+		origin -= drop * blocksize;
+	}
+	const size_t keep = static_cast<size_t>(((origin + front + sized - 1) >> blockbits) + 2);
+	if (blocks.size() > keep) {
+		for (size_t b = keep; b < blocks.size(); ++b) {
+			delete[] blocks[b];
+		}
+		blocks.resize(keep);
+	}
+
+	//only pos - front matters, so move both back to 0 once front drifts far
+	//enough; every node is touched, but only once per 2^29 removals
+	if (front > rebaseat || front < -rebaseat) {
+		for (node* n = head; n; n = n->next) {
+			n->pos -= front;
+		}
+		origin += front;
+		front = 0;
+	}
+}
+
+StudentList::node* StudentList::makenode(StudentInfo* d, node* n)
+{
+	return new (pool.allocate()) node(d, n);
+}
+
+void StudentList::freenode(node* n)
+{
+	pool.deallocate(n);
+}
+
+void StudentList::freeslots()
+{
+	for (size_t b = 0; b < blocks.size(); ++b) {
+		delete[] blocks[b];
+	}
+	blocks.clear();
+	front = 0;
+	origin = 0;
+}
+
 int StudentList::size() const
 {
 	return sized;
 }
 
+size_t StudentList::capacity() const
+{
+	return blocks.size() * blocksize;
+}
+
 StudentList::iterator StudentList::begin() const
 {
 	return iterator(head);
@@ -56,13 +145,19 @@ void StudentList::push_front(StudentInfo* ptr)
 		return;
 	}
 
-	node* n = new node(ptr, head);
+	reservefront();
+
+	node* n = makenode(ptr, head);
 	head = n;
 
 	if (!tail) {
 		tail = head;
 	}
 
+	--front;
+	n->pos = front;
+	slot(0) = n;
+
 	++sized;
 }
 
@@ -72,7 +167,9 @@ void StudentList::push_back(StudentInfo* ptr)
 		return;
 	}
 
-	node* n = new node(ptr);
+	reserveslot();
+
+	node* n = makenode(ptr);
 
 	if (!head) {
 		head = tail = n;
@@ -82,6 +179,9 @@ void StudentList::push_back(StudentInfo* ptr)
 		tail = n;
 	}
 
+	n->pos = front + sized;
+	slot(sized) = n;
+
 	++sized;
 }
 
@@ -91,12 +191,31 @@ StudentInfo* StudentList::at(int index) const
 		throw exceptionhandler("Index out of bounds (itemslist::at)");
 	}
 
-	node* cur = head;
-	for (int i = 0; i < index; ++i) {
-		cur = cur->next;
+	return slot(index)->data;
+}
+
+StudentList::handle StudentList::handleat(int index) const
+{
+	if (index < 0 || index >= sized) {
+		throw exceptionhandler("Index out of bounds (StudentList::handleat)");
 	}
+	return slot(index);
+}
 
-	return cur->data;
+int StudentList::indexof(handle h) const
+{
+	if (!h) {
+		return -1;
+	}
+	return h->pos - front;
+}
+
+StudentInfo* StudentList::get(handle h) const
+{
+	if (!h) {
+		return nullptr;
+	}
+	return h->data;
 }
 
 int StudentList::index_of_name(const string& name) const
@@ -117,12 +236,10 @@ bool StudentList::remove_at(int index, bool deleteItem)
 	}
 
 	node* prev = nullptr;
-	node* cur = head;
-
-	for (int i = 0; i < index; ++i) {
-		prev = cur;
-		cur = cur->next;
+	if (index > 0) {
+		prev = slot(index - 1);
 	}
+	node* cur = slot(index);
 
 	if (prev) {
 		prev->next = cur->next;
@@ -140,11 +257,31 @@ bool StudentList::remove_at(int index, bool deleteItem)
 		cur->data = nullptr;
 	}
 
-	delete cur;
+	freenode(cur);
+
+	//close the gap from whichever end is nearer
+	if (index < sized / 2) {
+		for (int i = index; i > 0; --i) {
+			slot(i) = slot(i - 1);
+			slot(i)->pos = front + i;
+		}
+		++front;
+	}
+	else {
+		for (int i = index; i < sized - 1; ++i) {
+			slot(i) = slot(i + 1);
+			slot(i)->pos = front + i;
+		}
+	}
 	--sized;
 
 	if (sized == 0) {
 		head = tail = nullptr;
+		freeslots();
+		pool.release();
+	}
+	else {
+		trimslots();
 	}
 
 	return true;
@@ -152,18 +289,79 @@ bool StudentList::remove_at(int index, bool deleteItem)
 
 void StudentList::clear(bool deleteItems)
 {
-	while (head) {
-		node* next = head->next;
-
-		if (deleteItems && head->data) {
-			delete head->data;
-			head->data = nullptr;
+	if (deleteItems) {
+		for (int i = 0; i < sized; ++i) {
+			delete slot(i)->data;
+			slot(i)->data = nullptr;
 		}
-
-		delete head;
-		head = next;
 	}
 
+	//nodes hold nothing that needs a destructor, so the slabs go in one go
+	head = nullptr;
 	tail = nullptr;
 	sized = 0;
+	freeslots();
+	pool.release();
+}
+
+void StudentList::sort(const studentorder& order)
+{
+	if (sized <= 1) {
+		return;
+	}
+
+	//bottom up: merge runs of width 1, 2, 4... by relinking next pointers,
+	//taking from the left run on ties so equal students keep their order
+	for (int width = 1; width < sized; width *= 2) {
+		node* rest = head;
+		node* newtail = nullptr;
+		head = nullptr;
+
+		while (rest) {
+			node* left = rest;
+			node* right = left;
+			int leftsize = 0;
+			while (right && leftsize < width) {
+				right = right->next;
+				++leftsize;
+			}
+			int rightsize = 0;
+			rest = right;
+			while (rest && rightsize < width) {
+				rest = rest->next;
+				++rightsize;
+			}
+
+			while (leftsize > 0 || rightsize > 0) {
+				node* pick;
+				if (rightsize == 0 || (leftsize > 0 && order.compare(left->data, right->data) <= 0)) {
+					pick = left;
+					left = left->next;
+					--leftsize;
+				}
+				else {
+					pick = right;
+					right = right->next;
+					--rightsize;
+				}
+
+				if (newtail) {
+					newtail->next = pick;
+				}
+				else {
+					head = pick;
+				}
+				newtail = pick;
+			}
+		}
+
+		newtail->next = nullptr;
+		tail = newtail;
+	}
+
+	int i = 0;
+	for (node* cur = head; cur; cur = cur->next, ++i) {
+		cur->pos = front + i;
+		slot(i) = cur;
+	}
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 #include <string>
+#include <vector>
 #include "exceptionhandler.h"
+#include "nodepool.h"
 using namespace std;
 class StudentInfo;
+class studentorder;
 
 class StudentList
 {
@@ -11,11 +14,16 @@ private:
 	{
 		StudentInfo* data;
 		node* next;
+		int pos; //where the node sits in the slot table, counted from front
 
 		node(StudentInfo*, node* = nullptr);
 	};
 
 public:
+	//stable reference to a roster entry, survives inserts and removals of
+	//other entries (the node never moves, only its position changes)
+	typedef const node* handle;
+
 	class iterator
 	{
 	public:
@@ -33,6 +41,8 @@ public:
 	~StudentList();
 
 	int size() const;
+	//slots allocated in the table, live or spare
+	size_t capacity() const;
 	iterator begin() const;
 
 	void push_back(StudentInfo*);
@@ -40,15 +50,46 @@ public:
 
 	StudentInfo* at(int) const;
 
+	handle handleat(int) const;
+	int indexof(handle) const;
+	StudentInfo* get(handle) const;
+
 
 	int index_of_name(const string&) const;
 
 	bool remove_at(int, bool);
 
+	//stable merge sort that relinks the nodes, handles stay valid
+	void sort(const studentorder&);
+
 	void clear(bool);
 
 private:
+	//slots hold a pointer to every node in list order, split into fixed size
+	//blocks so at() is a shift and a mask and growing never moves old blocks.
+	//there is free room kept on both ends, so push_front and push_back are
+	//amortized O(1); remove_at shifts whichever side of the index is shorter,
+	//which is O(min(i, n - i)) rather than O(1). blocks left behind by
+	//removals are freed beyond one spare at each end, so churn doesn't grow
+	//the table and pos is pulled back to 0 long before it could overflow
+	static const int blockbits = 10;
+	static const int blocksize = 1 << blockbits;
+	static const int rebaseat = 1 << 29;
+
+	node*& slot(int) const;
+	void reserveslot();
+	void reservefront();
+	void trimslots();
+	void freeslots();
+
+	node* makenode(StudentInfo*, node* = nullptr);
+	void freenode(node*);
+
 	node* head;
 	node* tail;
 	int sized;
+	int front; //pos of the node in slot 0, goes negative after push_front
+	int origin; //physical slot that pos 0 maps to
+	vector<node**> blocks;
+	nodepool<node> pool;
 };
\ No newline at end of file
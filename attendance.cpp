@@ -0,0 +1,200 @@
+#include "attendance.h"
+#include "rosterfilter.h"
+#include "exceptionhandler.h"
+#include "durablefile.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <limits>
+using namespace std;
+
+namespace {
+	const char attendmagic[8] = { 'D', 'O', 'J', 'O', 'A', 'T', 'T', 'N' };
+	const uint32_t attendversion = 1;
+
+	struct attendheader {
+		char magic[8];
+		uint32_t version;
+		int32_t firstday;
+		int32_t days;
+		uint32_t rows;
+	};
+	static_assert(sizeof(attendheader) == 24, "attendance header layout changed");
+}
+
+attendance::attendance(int32_t firstday, int span) : first(firstday), days(span), rowwords(0), rows(0), bits()
+{
+	if (span <= 0) {
+		throw exceptionhandler("attendance needs at least one day (attendance)");
+	}
+	rowwords = (span + 63) / 64;
+}
+
+int32_t attendance::firstday() const
+{
+	return first;
+}
+
+int32_t attendance::lastday() const
+{
+	return first + days - 1;
+}
+
+uint32_t attendance::rowcount() const
+{
+	return rows;
+}
+
+size_t attendance::bytes() const
+{
+	return bits.size() * sizeof(uint64_t);
+}
+
+void attendance::checkin(uint32_t id, int32_t day)
+{
+	const int bit = bitof(day, "attendance::checkin");
+	if (id >= maxrows) {
+		throw exceptionhandler("student id out of range (attendance::checkin)");
+	}
+	growto(id)[bit >> 6] |= uint64_t(1) << (bit & 63);
+}
+
+void attendance::undo(uint32_t id, int32_t day)
+{
+	const int bit = bitof(day, "attendance::undo");
+	if (id < rows) {
+		growto(id)[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+	}
+}
+
+bool attendance::attended(uint32_t id, int32_t day) const
+{
+	const uint64_t* r = row(id);
+	if (!r || day < first || day > lastday()) {
+		return false;
+	}
+	const int bit = day - first;
+	return (r[bit >> 6] >> (bit & 63)) & 1;
+}
+
+int attendance::count(uint32_t id, int32_t from, int32_t to) const
+{
+	const uint64_t* r = row(id);
+	if (!r) {
+		return 0;
+	}
+	const int32_t lo = from < first ? first : from;
+	const int32_t hi = to > lastday() ? lastday() : to;
+	if (lo > hi) {
+		return 0;
+	}
+	return countbits(r, lo - first, hi - first);
+}
+
+int attendance::recent(uint32_t id, int32_t today, int n) const
+{
+	return count(id, today - n + 1, today);
+}
+
+void attendance::counts(const uint32_t* ids, size_t n, int32_t from, int32_t to, int* out) const
+{
+	const int32_t lo = from < first ? first : from;
+	const int32_t hi = to > lastday() ? lastday() : to;
+	for (size_t i = 0; i < n; ++i) {
+		const uint64_t* r = row(ids[i]);
+		out[i] = (r && lo <= hi) ? countbits(r, lo - first, hi - first) : 0;
+	}
+}
+
+void attendance::save(const string& path) const
+{
+	const string temp = path + ".tmp";
+	ofstream out(temp.c_str(), ios::binary | ios::trunc);
+	if (!out) {
+		throw exceptionhandler("could not create " + temp + " (attendance::save)");
+	}
+	attendheader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, attendmagic, sizeof(attendmagic));
+	head.version = attendversion;
+	head.firstday = first;
+	head.days = days;
+	head.rows = rows;
+	out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+	out.write(reinterpret_cast<const char*>(bits.data()), static_cast<streamsize>(bits.size() * sizeof(uint64_t)));
+	out.close();
+	if (!out) {
+		throw exceptionhandler("could not write " + temp + " (attendance::save)");
+	}
+	//the old file stays whole until the new one is on disk
+	durablefile::replace(temp, path);
+}
+
+void attendance::load(const string& path)
+{
+	ifstream in(path.c_str(), ios::binary);
+	if (!in) {
+		throw exceptionhandler("could not open " + path + " (attendance::load)");
+	}
+	attendheader head;
+	if (!in.read(reinterpret_cast<char*>(&head), sizeof(head)) || memcmp(head.magic, attendmagic, sizeof(attendmagic)) != 0
+		|| head.version != attendversion || head.days <= 0 || head.rows > maxrows
+		|| static_cast<int64_t>(head.firstday) + head.days - 1 > numeric_limits<int32_t>::max()) {
+		throw exceptionhandler(path + " is not an attendance file (attendance::load)");
+	}
+	//nothing is allocated until the header agrees with the file
+	const uint64_t words = static_cast<uint64_t>(head.rows) * ((static_cast<uint64_t>(head.days) + 63) / 64);
+	error_code failed;
+	const uintmax_t size = filesystem::file_size(path, failed);
+	if (failed || size != sizeof(head) + words * sizeof(uint64_t)) {
+		throw exceptionhandler(path + " is truncated or corrupt (attendance::load)");
+	}
+	vector<uint64_t> loaded(static_cast<size_t>(words));
+	if (!in.read(reinterpret_cast<char*>(loaded.data()), static_cast<streamsize>(loaded.size() * sizeof(uint64_t)))) {
+		throw exceptionhandler(path + " is truncated (attendance::load)");
+	}
+	first = head.firstday;
+	days = head.days;
+	rowwords = (days + 63) / 64;
+	rows = head.rows;
+	bits.swap(loaded);
+}
+
+int attendance::bitof(int32_t day, const char* where) const
+{
+	if (day < first || day > lastday()) {
+		throw exceptionhandler(string("day outside the attendance window (") + where + ")");
+	}
+	return day - first;
+}
+
+uint64_t* attendance::growto(uint32_t id)
+{
+	if (id >= rows) {
+		rows = id + 1;
+		bits.resize(static_cast<size_t>(rows) * rowwords, 0);
+	}
+	return bits.data() + static_cast<size_t>(id) * rowwords;
+}
+
+const uint64_t* attendance::row(uint32_t id) const
+{
+	return id < rows ? bits.data() + static_cast<size_t>(id) * rowwords : nullptr;
+}
+
+//bits lo .. hi of a row, partial words masked at both ends
+int attendance::countbits(const uint64_t* r, int lo, int hi) const
+{
+	const int wlo = lo >> 6;
+	const int whi = hi >> 6;
+	const uint64_t lowmask = ~uint64_t(0) << (lo & 63);
+	const uint64_t highmask = ~uint64_t(0) >> (63 - (hi & 63));
+	if (wlo == whi) {
+		return rosterfilter::popcount(r[wlo] & lowmask & highmask);
+	}
+	int total = rosterfilter::popcount(r[wlo] & lowmask);
+	for (int w = wlo + 1; w < whi; ++w) {
+		total += rosterfilter::popcount(r[w]);
+	}
+	return total + rosterfilter::popcount(r[whi] & highmask);
+}
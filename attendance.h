@@ -0,0 +1,54 @@
+//who came to class on which day: one bit per student per calendar day,
+//packed into 64 bit words with one fixed length row per StudentInfo id.
+//days are enrolldate day numbers. five years is 29 words a student, so a
+//million students take about 230MB; ids have to be below maxrows
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+class attendance
+{
+public:
+	static const int defaultdays = 5 * 366;
+	static const uint32_t maxrows = 1u << 24;
+
+	//tracks days firstday .. firstday + days - 1
+	explicit attendance(int32_t, int = defaultdays);
+
+	int32_t firstday() const;
+	int32_t lastday() const;
+	uint32_t rowcount() const; //highest id seen + 1
+	size_t bytes() const;
+
+	//throws exceptionhandler for a day outside the window or an id past maxrows
+	void checkin(uint32_t, int32_t);
+	void undo(uint32_t, int32_t);
+	bool attended(uint32_t, int32_t) const;
+
+	//days attended from .. to (both included), clipped to the window
+	int count(uint32_t, int32_t, int32_t) const;
+	//the last n days up to today, ex: recent(id, enrolldate::today(), 90)
+	int recent(uint32_t, int32_t, int) const;
+	//count() for a batch of ids into out
+	void counts(const uint32_t*, size_t, int32_t, int32_t, int*) const;
+
+	//save goes through a synced temp file, load checks the header against
+	//the file's size before reading any of it
+	void save(const string&) const;
+	void load(const string&);
+
+private:
+	int32_t first;
+	int days;
+	int rowwords;
+	uint32_t rows;
+	vector<uint64_t> bits; //row id starts at bits[id * rowwords]
+
+	int bitof(int32_t, const char*) const;
+	uint64_t* growto(uint32_t);
+	const uint64_t* row(uint32_t) const;
+	int countbits(const uint64_t*, int, int) const;
+};
@@ -0,0 +1,135 @@
+//one place for belt rank and stripe names. the tables are built at compile
+//time: name lookups are an array index and parse() is a perfect hash, so
+//reports and imports don't walk if-chains per row
+#pragma once
+#include <string_view>
+#include <cstddef>
+using namespace std;
+
+template <size_t N>
+class enumtable
+{
+public:
+	static constexpr size_t maxname = 15;
+	static constexpr size_t slotcount = 32;
+
+	template <size_t W>
+	struct paddedlabels {
+		char text[N][W + 1];
+		constexpr string_view at(size_t i) const { return string_view(text[i], W); }
+	};
+
+	constexpr enumtable(const char* const (&list)[N]) : text(), lower(), length(), seed(0), slots()
+	{
+		for (size_t i = 0; i < N; ++i) {
+			size_t n = 0;
+			while (list[i][n] != '\0' && n < maxname) {
+				text[i][n] = list[i][n];
+				lower[i][n] = fold(list[i][n]);
+				++n;
+			}
+			length[i] = n;
+		}
+		//smallest seed where no two names land in the same slot
+		for (unsigned s = 1; s < 1000 && seed == 0; ++s) {
+			for (size_t k = 0; k < slotcount; ++k) {
+				slots[k] = -1;
+			}
+			bool clash = false;
+			for (size_t i = 0; i < N && !clash; ++i) {
+				const size_t k = hashof(string_view(text[i], length[i]), s);
+				clash = slots[k] != -1;
+				slots[k] = static_cast<signed char>(i);
+			}
+			if (!clash) {
+				seed = s;
+			}
+		}
+	}
+
+	constexpr size_t size() const { return N; }
+	constexpr bool hashok() const { return seed != 0; }
+	constexpr size_t longest() const
+	{
+		size_t most = 0;
+		for (size_t i = 0; i < N; ++i) {
+			most = length[i] > most ? length[i] : most;
+		}
+		return most;
+	}
+
+	//null terminated, fallback when the value isn't one of the names
+	constexpr const char* cname(int value, const char* fallback) const
+	{
+		return (value >= 0 && static_cast<size_t>(value) < N) ? text[value] : fallback;
+	}
+	constexpr string_view name(int value, string_view fallback = string_view()) const
+	{
+		return (value >= 0 && static_cast<size_t>(value) < N) ? string_view(text[value], length[value]) : fallback;
+	}
+	constexpr string_view lowername(int value, string_view fallback = string_view()) const
+	{
+		return (value >= 0 && static_cast<size_t>(value) < N) ? string_view(lower[value], length[value]) : fallback;
+	}
+
+	//case insensitive name to value, -1 if it isn't one
+	constexpr int parse(string_view word) const
+	{
+		if (word.empty() || word.size() > maxname) {
+			return -1;
+		}
+		const int i = slots[hashof(word, seed)];
+		if (i < 0 || length[i] != word.size()) {
+			return -1;
+		}
+		for (size_t c = 0; c < word.size(); ++c) {
+			if (fold(word[c]) != lower[i][c]) {
+				return -1;
+			}
+		}
+		return i;
+	}
+
+	//every name left aligned and space padded to W, ready to copy into a row
+	template <size_t W>
+	constexpr paddedlabels<W> padded(bool lowercase) const
+	{
+		paddedlabels<W> labels = {};
+		for (size_t i = 0; i < N; ++i) {
+			for (size_t c = 0; c < W; ++c) {
+				labels.text[i][c] = c < length[i] ? (lowercase ? lower[i][c] : text[i][c]) : ' ';
+			}
+		}
+		return labels;
+	}
+
+private:
+	char text[N][maxname + 1];
+	char lower[N][maxname + 1];
+	size_t length[N];
+	unsigned seed;
+	signed char slots[slotcount];
+
+	static constexpr char fold(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	static constexpr size_t hashof(string_view word, unsigned s)
+	{
+		const unsigned first = static_cast<unsigned char>(fold(word[0]));
+		const unsigned last = static_cast<unsigned char>(fold(word[word.size() - 1]));
+		return (first * s + last * 7 + static_cast<unsigned>(word.size()) * 13) % slotcount;
+	}
+};
+
+namespace beltnames {
+	constexpr const char* const ranklist[] = { "White", "Yellow", "Green", "Blue", "Purple", "Brown", "Black" };
+	constexpr const char* const stripelist[] = { "Zero", "One", "Two", "Three", "Four" };
+
+	inline constexpr enumtable<7> ranks(ranklist);
+	inline constexpr enumtable<5> stripes(stripelist);
+
+	static_assert(ranks.hashok(), "no perfect hash seed for the rank names");
+	static_assert(stripes.hashok(), "no perfect hash seed for the stripe names");
+}
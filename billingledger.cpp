@@ -0,0 +1,314 @@
+#include "billingledger.h"
+#include "exceptionhandler.h"
+#include "durablefile.h"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+//file = header, then entries exactly as they sit in memory
+namespace {
+	static_assert(sizeof(billingledger::entry) == 12, "ledger entry layout changed");
+	const int firstyear = 2000;
+	const int lastmonth = 0xFFFF;
+	const char ledgermagic[8] = { 'D', 'O', 'J', 'O', 'L', 'D', 'G', 'R' };
+	const uint32_t ledgerversion = 1;
+
+	struct ledgerheader {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+	};
+	static_assert(sizeof(ledgerheader) == 16, "ledger header layout changed");
+
+	int32_t entrycents(int64_t cents, const string& where)
+	{
+		if (cents < numeric_limits<int32_t>::min() || cents > numeric_limits<int32_t>::max()) {
+			throw exceptionhandler("amount too large for one entry (" + where + ")");
+		}
+		return static_cast<int32_t>(cents);
+	}
+}
+
+billingledger::studenttotals::studenttotals() : charged(0), paid(0), lastcharge(-1), month(-1)
+{
+}
+
+int64_t billingledger::studenttotals::balance() const
+{
+	return charged - paid;
+}
+
+billingledger::monthtotals::monthtotals() : charged(0), paid(0), entries(0)
+{
+}
+
+billingledger::billingledger() : blocks(), count(0), saved(0), savedpath(), savedbytes(0), students(), months(), history()
+{
+}
+
+int billingledger::monthof(int year, int month)
+{
+	const int m = (year - firstyear) * 12 + (month - 1);
+	if (year < firstyear || month < 1 || month > 12 || m > lastmonth) {
+		throw exceptionhandler("month out of range (billingledger::monthof)");
+	}
+	return m;
+}
+
+int64_t billingledger::centsof(double dollars)
+{
+	return static_cast<int64_t>(llround(dollars * 100.0));
+}
+
+void billingledger::charge(uint32_t student, int m, int64_t cents)
+{
+	if (m < 0 || m > lastmonth) {
+		throw exceptionhandler("month out of range (billingledger::charge)");
+	}
+	entry e = { student, entrycents(cents, "billingledger::charge"), static_cast<uint16_t>(m), chargeentry, 0 };
+	post(e);
+}
+
+void billingledger::pay(uint32_t student, int m, int64_t cents)
+{
+	if (m < 0 || m > lastmonth) {
+		throw exceptionhandler("month out of range (billingledger::pay)");
+	}
+	entry e = { student, entrycents(cents, "billingledger::pay"), static_cast<uint16_t>(m), paymententry, 0 };
+	post(e);
+}
+
+void billingledger::check(const entry& e, const string& where)
+{
+	if (e.kind != chargeentry && e.kind != paymententry) {
+		throw exceptionhandler("unknown entry kind (" + where + ")");
+	}
+	if (e.student >= maxstudents) {
+		throw exceptionhandler("student number out of range (" + where + ")");
+	}
+}
+
+void billingledger::post(const entry& e)
+{
+	check(e, "billingledger::post");
+	if (count == blocks.size() * blocksize) {
+		blocks.push_back(vector<entry>());
+		blocks.back().reserve(blocksize);
+	}
+	blocks.back().push_back(e);
+	++count;
+	rollup(e);
+}
+
+size_t billingledger::size() const
+{
+	return count;
+}
+
+const billingledger::entry& billingledger::at(size_t i) const
+{
+	if (i >= count) {
+		throw exceptionhandler("Index out of bounds (billingledger::at)");
+	}
+	return blocks[i >> blockbits][i & (blocksize - 1)];
+}
+
+const billingledger::studenttotals& billingledger::student(uint32_t s) const
+{
+	static const studenttotals none;
+	return s < students.size() ? students[s] : none;
+}
+
+const billingledger::monthtotals& billingledger::month(int m) const
+{
+	static const monthtotals none;
+	return m >= 0 && static_cast<size_t>(m) < months.size() ? months[m] : none;
+}
+
+int64_t billingledger::due(uint32_t s, int m) const
+{
+	const studenttotals& st = student(s);
+	if (m >= st.month) {
+		return st.balance();
+	}
+	if (s >= history.size()) {
+		return 0;
+	}
+	//the last month at or before m carries the balance through m
+	const vector<runningbalance>& h = history[s];
+	vector<runningbalance>::const_iterator after = upper_bound(h.begin(), h.end(), m,
+		[](int month, const runningbalance& r) { return month < r.month; });
+	return after == h.begin() ? 0 : (after - 1)->balance;
+}
+
+vector<billingledger::owing> billingledger::owingfor(int m) const
+{
+	vector<owing> result;
+	for (size_t s = 0; s < students.size(); ++s) {
+		const int64_t owed = due(static_cast<uint32_t>(s), m);
+		if (owed > 0) {
+			owing o = { static_cast<uint32_t>(s), owed };
+			result.push_back(o);
+		}
+	}
+	return result;
+}
+
+void billingledger::save(const string& path)
+{
+	error_code failed;
+	uint64_t start = filesystem::exists(path, failed) ? filesystem::file_size(path, failed) : 0;
+	if (failed) {
+		throw exceptionhandler("could not read the size of " + path + " (billingledger::save)");
+	}
+	//only the file this ledger last saved or loaded already holds the
+	//entries before saved; anywhere else, or if that file lost some, the
+	//whole ledger goes down again
+	if (path != savedpath || start < savedbytes) {
+		writeall(path);
+		return;
+	}
+	//a save that threw part way may have left a torn tail past the last
+	//good save, cut it so the file stays whole entries
+	if (start > savedbytes) {
+		filesystem::resize_file(path, savedbytes, failed);
+		if (failed) {
+			throw exceptionhandler("could not trim " + path + " (billingledger::save)");
+		}
+		start = savedbytes;
+	}
+
+	ofstream out(path.c_str(), ios::binary | ios::app);
+	if (!out) {
+		throw exceptionhandler("could not open " + path + " (billingledger::save)");
+	}
+	//whole blocks are contiguous, write them a block at a time. saved only
+	//moves once the bytes are synced, so a failure writes them all again
+	size_t done = saved;
+	while (done < count) {
+		const vector<entry>& block = blocks[done >> blockbits];
+		const size_t first = done & (blocksize - 1);
+		const size_t n = block.size() - first;
+		out.write(reinterpret_cast<const char*>(block.data() + first), static_cast<streamsize>(n * sizeof(entry)));
+		if (!out) {
+			throw exceptionhandler("could not write " + path + " (billingledger::save)");
+		}
+		done += n;
+	}
+	out.close();
+	if (!out) {
+		throw exceptionhandler("could not write " + path + " (billingledger::save)");
+	}
+	durablefile::syncfile(path);
+
+	savedbytes = start + static_cast<uint64_t>(count - saved) * sizeof(entry);
+	saved = count;
+}
+
+void billingledger::writeall(const string& path)
+{
+	const string temp = path + ".tmp";
+	ofstream out(temp.c_str(), ios::binary | ios::trunc);
+	if (!out) {
+		throw exceptionhandler("could not open " + temp + " (billingledger::save)");
+	}
+	ledgerheader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, ledgermagic, sizeof(head.magic));
+	head.version = ledgerversion;
+	out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+	for (size_t b = 0; b < blocks.size() && out; ++b) {
+		out.write(reinterpret_cast<const char*>(blocks[b].data()), static_cast<streamsize>(blocks[b].size() * sizeof(entry)));
+	}
+	out.close();
+	if (!out) {
+		throw exceptionhandler("could not write " + temp + " (billingledger::save)");
+	}
+	durablefile::replace(temp, path);
+
+	savedpath = path;
+	savedbytes = sizeof(ledgerheader) + static_cast<uint64_t>(count) * sizeof(entry);
+	saved = count;
+}
+
+void billingledger::load(const string& path)
+{
+	ifstream in(path.c_str(), ios::binary);
+	if (!in) {
+		throw exceptionhandler("could not open " + path + " (billingledger::load)");
+	}
+	ledgerheader head;
+	if (!in.read(reinterpret_cast<char*>(&head), sizeof(head)) || memcmp(head.magic, ledgermagic, sizeof(head.magic)) != 0) {
+		throw exceptionhandler(path + " is not a billing ledger (billingledger::load)");
+	}
+	if (head.version != ledgerversion) {
+		throw exceptionhandler(path + " has an unsupported ledger version (billingledger::load)");
+	}
+
+	//built off to the side, a bad entry leaves this ledger as it was
+	billingledger loaded;
+	vector<entry> chunk(blocksize);
+	while (in) {
+		in.read(reinterpret_cast<char*>(chunk.data()), static_cast<streamsize>(chunk.size() * sizeof(entry)));
+		const size_t n = static_cast<size_t>(in.gcount()) / sizeof(entry);
+		for (size_t i = 0; i < n; ++i) {
+			check(chunk[i], "billingledger::load");
+			loaded.post(chunk[i]);
+		}
+	}
+	//a torn entry at the end is dropped here and trimmed by the next save
+	loaded.saved = loaded.count;
+	loaded.savedpath = path;
+	loaded.savedbytes = sizeof(ledgerheader) + static_cast<uint64_t>(loaded.count) * sizeof(entry);
+	*this = move(loaded);
+}
+
+void billingledger::rollup(const entry& e)
+{
+	if (e.student >= students.size()) {
+		students.resize(static_cast<size_t>(e.student) + 1);
+	}
+	if (e.month >= months.size()) {
+		months.resize(static_cast<size_t>(e.month) + 1);
+	}
+	if (e.student >= history.size()) {
+		history.resize(static_cast<size_t>(e.student) + 1);
+	}
+	studenttotals& st = students[e.student];
+	monthtotals& mt = months[e.month];
+	const int m = e.month;
+
+	if (m > st.month) {
+		st.month = m;
+	}
+	if (e.kind == chargeentry) {
+		st.charged += e.cents;
+		mt.charged += e.cents;
+		if (m > st.lastcharge) {
+			st.lastcharge = m;
+		}
+	}
+	else {
+		st.paid += e.cents;
+		mt.paid += e.cents;
+	}
+	++mt.entries;
+
+	//the entry's month and every later month the student has owe it too.
+	//entries mostly come in month order, so this is usually the last one
+	vector<runningbalance>& h = history[e.student];
+	const int64_t delta = (e.kind == chargeentry) ? e.cents : -static_cast<int64_t>(e.cents);
+	vector<runningbalance>::iterator at = lower_bound(h.begin(), h.end(), m,
+		[](const runningbalance& r, int month) { return r.month < month; });
+	if (at == h.end() || at->month != m) {
+		runningbalance r = { m, at == h.begin() ? 0 : (at - 1)->balance };
+		at = h.insert(at, r);
+	}
+	for (; at != h.end(); ++at) {
+		at->balance += delta;
+	}
+}
@@ -0,0 +1,106 @@
+//append-only ledger of tuition charges and payments. entries are never
+//changed once posted; per student and per month totals are updated as each
+//entry goes in, so balances and "who owes this month" never replay history.
+//money is in cents, months count from January 2000 (see monthof) and
+//students are numbered densely from 0, below maxstudents
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+class billingledger
+{
+public:
+	enum entrykind : uint8_t {
+		chargeentry,
+		paymententry
+	};
+
+	struct entry {
+		uint32_t student;
+		int32_t cents;
+		uint16_t month;
+		uint8_t kind; //entrykind
+		uint8_t reserved;
+	};
+
+	struct studenttotals {
+		int64_t charged;
+		int64_t paid;
+		int lastcharge; //month of the latest charge, -1 if none
+		int month; //latest month with any entry, -1 if none
+
+		studenttotals();
+		int64_t balance() const;
+	};
+
+	struct monthtotals {
+		int64_t charged;
+		int64_t paid;
+		int entries;
+
+		monthtotals();
+	};
+
+	struct owing {
+		uint32_t student;
+		int64_t cents;
+	};
+
+	static const uint32_t maxstudents = 1u << 24;
+
+	billingledger();
+
+	static int monthof(int, int); //year, month 1-12
+	static int64_t centsof(double);
+
+	//throw exceptionhandler for a student, month or amount an entry can't hold
+	void charge(uint32_t, int, int64_t);
+	void pay(uint32_t, int, int64_t);
+	void post(const entry&);
+
+	size_t size() const;
+	const entry& at(size_t) const;
+
+	//students with no entries read as all zero
+	const studenttotals& student(uint32_t) const;
+	const monthtotals& month(int) const;
+	//still owed as of month: charges for that month or earlier less payments
+	//for that month or earlier, so unpaid older months count too. read from
+	//the student's running balance, a binary search over their months
+	int64_t due(uint32_t, int) const;
+	//students with something due as of month, by student number
+	vector<owing> owingfor(int) const;
+
+	//saving again to the file last saved or loaded appends the entries
+	//posted since and fsyncs them; if a save throws, the next one cuts the
+	//file back to the last good save first and writes them again. any other
+	//path gets the whole ledger through a synced temp file. load checks the
+	//header and every entry, the ledger is only replaced if all of it reads
+	void save(const string&);
+	void load(const string&);
+
+private:
+	//balance owed through month, one per month the student has entries in
+	struct runningbalance {
+		int month;
+		int64_t balance;
+	};
+
+	static const int blockbits = 16;
+	static const size_t blocksize = size_t(1) << blockbits;
+	vector<vector<entry>> blocks; //full blocks never move
+	size_t count;
+	size_t saved; //entries known to be on disk in savedpath
+	string savedpath;
+	uint64_t savedbytes; //size of savedpath after the last good save or load
+	vector<studenttotals> students;
+	vector<monthtotals> months;
+	vector<vector<runningbalance>> history; //per student, by month
+
+	static void check(const entry&, const string&);
+	void rollup(const entry&);
+	void writeall(const string&);
+};
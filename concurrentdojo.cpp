@@ -0,0 +1,165 @@
+#include "concurrentdojo.h"
+#include "exceptionhandler.h"
+#include <algorithm>
+using namespace std;
+
+concurrentdojo::readview::readview() : data()
+{
+}
+
+concurrentdojo::readview::readview(shared_ptr<const snapshotdata> d) : data(d)
+{
+}
+
+int concurrentdojo::readview::getsize() const
+{
+	return data ? data->count : 0;
+}
+
+const concurrentdojo::studentrecord& concurrentdojo::readview::at(int index) const
+{
+	if (index < 0 || index >= getsize()) {
+		throw exceptionhandler("Index out of bounds (concurrentdojo::readview::at)");
+	}
+	return (*data->table->chunks[index / chunkrows])[index % chunkrows];
+}
+
+double concurrentdojo::readview::totalvalue() const
+{
+	return data ? data->totalvalue : 0.0;
+}
+
+int concurrentdojo::readview::seqsearch(const string& name) const
+{
+	const int n = getsize();
+	for (int i = 0; i < n; ++i) {
+		if (at(i).name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+concurrentdojo::concurrentdojo() : writelock(), roster(), publishlock(), current()
+{
+	shared_ptr<snapshotdata> empty = make_shared<snapshotdata>();
+	empty->table = make_shared<chunktable>();
+	empty->count = 0;
+	empty->totalvalue = 0.0;
+	current = empty;
+}
+
+concurrentdojo::readview concurrentdojo::read() const
+{
+	lock_guard<mutex> guard(publishlock);
+	return readview(current);
+}
+
+concurrentdojo& concurrentdojo::operator+=(StudentInfo* ptr)
+{
+	if (!ptr) {
+		return *this;
+	}
+	lock_guard<mutex> guard(writelock);
+	roster += ptr;
+
+	//current only changes under writelock, which is held, so no publishlock
+	//to look at it. the new row and chunk slot sit past every published
+	//count, no reader can be looking at them
+	const snapshotdata& old = *current;
+	shared_ptr<snapshotdata> next = make_shared<snapshotdata>(old);
+	const int index = old.count;
+	const int at = index / chunkrows;
+	if (index % chunkrows == 0) {
+		if (at == static_cast<int>(old.table->chunks.size())) {
+			shared_ptr<chunktable> grown = make_shared<chunktable>();
+			grown->chunks.resize(max(4, at * 2));
+			copy(old.table->chunks.begin(), old.table->chunks.end(), grown->chunks.begin());
+			next->table = grown;
+		}
+		next->table->chunks[at] = make_shared<chunk>();
+	}
+	(*next->table->chunks[at])[index % chunkrows] = copyof(ptr);
+	next->count = old.count + 1;
+	next->totalvalue = roster.totalvalue();
+	publish(next);
+	return *this;
+}
+
+concurrentdojo& concurrentdojo::operator-=(int index)
+{
+	lock_guard<mutex> guard(writelock);
+	roster -= index; //throws before anything is published if index is bad
+	//everything from the removed row on moves up one, so those chunks are rebuilt
+	publish(rebuildfrom(*current, index));
+	return *this;
+}
+
+void concurrentdojo::edit(int index, const function<void(StudentInfo*)>& change)
+{
+	lock_guard<mutex> guard(writelock);
+	StudentInfo* cur = roster[index];
+	change(cur);
+
+	//older snapshots keep the old chunk, so this one gets its own table too
+	const snapshotdata& old = *current;
+	shared_ptr<snapshotdata> next = make_shared<snapshotdata>(old);
+	next->table = make_shared<chunktable>(*old.table);
+	shared_ptr<chunk> changed = make_shared<chunk>(*old.table->chunks[index / chunkrows]);
+	(*changed)[index % chunkrows] = copyof(cur);
+	next->table->chunks[index / chunkrows] = changed;
+	next->totalvalue = roster.totalvalue();
+	publish(next);
+}
+
+void concurrentdojo::write(const function<void(DojoManager&)>& change)
+{
+	lock_guard<mutex> guard(writelock);
+	change(roster);
+	publish(rebuildfrom(*current, 0));
+}
+
+concurrentdojo::studentrecord concurrentdojo::copyof(const StudentInfo* s)
+{
+	studentrecord rec;
+	rec.name = s ? s->getName() : string();
+	rec.contact = s ? s->getContact() : string();
+	rec.age = s ? s->getAge() : 0;
+	rec.months = s ? s->getMonths() : 0;
+	rec.rank = s ? s->getRank() : StudentInfo::White;
+	rec.stripes = s ? s->getStripes() : StudentInfo::zero;
+	rec.needsgear = s ? s->getGear() : false;
+	rec.returning = s ? s->getReturning() : false;
+	rec.value = s ? s->getvalue() : 0.0;
+	return rec;
+}
+
+void concurrentdojo::publish(shared_ptr<const snapshotdata> next)
+{
+	lock_guard<mutex> guard(publishlock);
+	current.swap(next);
+	//the old snapshot is released after the lock, in next's destructor
+}
+
+//keeps the chunks before the one holding row first, rebuilds the rest from the roster
+shared_ptr<concurrentdojo::snapshotdata> concurrentdojo::rebuildfrom(const snapshotdata& old, int first) const
+{
+	shared_ptr<snapshotdata> next = make_shared<snapshotdata>();
+	next->table = make_shared<chunktable>();
+	const int keep = first / chunkrows;
+	vector<shared_ptr<chunk>>& chunks = next->table->chunks;
+	chunks.assign(old.table->chunks.begin(), old.table->chunks.begin() + keep);
+
+	const int n = roster.getsize();
+	for (int start = keep * chunkrows; start < n; start += chunkrows) {
+		shared_ptr<chunk> rows = make_shared<chunk>();
+		const int end = (start + chunkrows < n) ? start + chunkrows : n;
+		for (int i = start; i < end; ++i) {
+			(*rows)[i - start] = copyof(roster.getind(i));
+		}
+		chunks.push_back(rows);
+	}
+	next->count = n;
+	next->totalvalue = roster.totalvalue();
+	return next;
+}
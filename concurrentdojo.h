@@ -0,0 +1,88 @@
+//DojoManager shared by several front desk threads and a report thread.
+//writers take the writer lock, readers copy out the latest published
+//snapshot under a separate lock held only for that pointer copy, so a read
+//never waits on roster work. not lock-free: it's the pointer handoff that
+//is locked. a snapshot is immutable and lives until its last reader drops it
+#pragma once
+#include "DojoManager.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <string>
+#include <vector>
+using namespace std;
+
+class concurrentdojo
+{
+public:
+	//copy of one student as it was when the snapshot was published
+	struct studentrecord {
+		string name;
+		string contact;
+		int age;
+		int months;
+		StudentInfo::BeltRank rank;
+		StudentInfo::BeltStripes stripes;
+		bool needsgear;
+		bool returning;
+		double value;
+	};
+
+private:
+	static const int chunkrows = 1024;
+	//records live in fixed chunks shared between snapshots. rows below a
+	//snapshot's count never change after it's published, so an append fills
+	//the next free row of the last chunk in place (O(1)), and an edit copies
+	//just the chunk it touches
+	typedef array<studentrecord, chunkrows> chunk;
+	//chunk pointers, also filled in place past the published end. it is
+	//copied at double the size when full, or as is when an edit swaps a chunk
+	struct chunktable {
+		vector<shared_ptr<chunk>> chunks;
+	};
+	struct snapshotdata {
+		shared_ptr<chunktable> table;
+		int count;
+		double totalvalue;
+	};
+
+public:
+	class readview {
+	public:
+		readview();
+		int getsize() const;
+		const studentrecord& at(int) const;
+		double totalvalue() const;
+		int seqsearch(const string&) const;
+	private:
+		friend class concurrentdojo;
+		explicit readview(shared_ptr<const snapshotdata>);
+		shared_ptr<const snapshotdata> data;
+	};
+
+	concurrentdojo();
+
+	//never waits for a writer's roster change, only for the pointer copy
+	readview read() const;
+
+	concurrentdojo& operator+=(StudentInfo*);
+	concurrentdojo& operator-=(int);
+	//change a student under the writer lock, ex: edit(3, [](StudentInfo* s) { s->setRank(StudentInfo::Blue); })
+	void edit(int, const function<void(StudentInfo*)>&);
+	//any other change to the roster, republishes everything afterwards
+	void write(const function<void(DojoManager&)>&);
+
+private:
+	mutable mutex writelock;
+	DojoManager roster; //only touched with writelock held
+	mutable mutex publishlock; //guards current, held for a pointer copy only
+	shared_ptr<const snapshotdata> current; //written with both locks held
+
+	static studentrecord copyof(const StudentInfo*);
+	void publish(shared_ptr<const snapshotdata>);
+	shared_ptr<snapshotdata> rebuildfrom(const snapshotdata&, int) const;
+
+	concurrentdojo(const concurrentdojo&);
+	concurrentdojo& operator=(const concurrentdojo&);
+};
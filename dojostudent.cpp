@@ -0,0 +1,20 @@
+#include "dojostudent.h"
+#include "FinancialSystem.h"
+using namespace std;
+
+dojostudent::dojostudent() : StudentInfo() {
+
+}
+dojostudent::dojostudent(const string& name, int age, bool isReturning,
+	int monthsEnrolled, BeltRank rank, BeltStripes stripes, bool needsGear, const string& contact)
+	: StudentInfo(name, age, isReturning, monthsEnrolled, rank, stripes, needsGear, contact) {
+
+}
+
+dojostudent::~dojostudent() {
+
+}
+
+double dojostudent::getvalue() const {
+	return FinancialSystem::priceof(getAge(), getGear());
+}
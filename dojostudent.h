@@ -0,0 +1,15 @@
+//plain roster student, what loaders build when there's no other subclass
+#pragma once
+#include "StudentInfo.h"
+#include <string>
+using namespace std;
+
+class dojostudent : public StudentInfo {
+public:
+	dojostudent();
+	dojostudent(const string&, int, bool, int, BeltRank, BeltStripes, bool, const string&);
+	virtual ~dojostudent();
+
+	//monthly price from FinancialSystem::pricegen
+	virtual double getvalue() const override;
+};
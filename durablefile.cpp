@@ -0,0 +1,79 @@
+//windows.h goes first, same as in mappedfile.cpp
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+#include "durablefile.h"
+#include "exceptionhandler.h"
+#include <cstdio>
+#include <filesystem>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+
+void durablefile::syncfile(const string& path)
+{
+#ifdef _WIN32
+	const int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+	if (fd < 0) {
+		throw exceptionhandler("could not open " + path + " (durablefile::syncfile)");
+	}
+	const bool ok = _commit(fd) == 0;
+	_close(fd);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw exceptionhandler("could not open " + path + " (durablefile::syncfile)");
+	}
+	const bool ok = fsync(fd) == 0;
+	::close(fd);
+#endif
+	if (!ok) {
+		throw exceptionhandler("could not sync " + path + " (durablefile::syncfile)");
+	}
+}
+
+void durablefile::syncdir(const string& path)
+{
+#ifdef _WIN32
+	//ntfs journals the rename itself, MoveFileEx write through covers it
+	(void)path;
+#else
+	string dir = filesystem::path(path).parent_path().string();
+	if (dir.empty()) {
+		dir = ".";
+	}
+	const int fd = ::open(dir.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw exceptionhandler("could not open " + dir + " (durablefile::syncdir)");
+	}
+	const bool ok = fsync(fd) == 0;
+	::close(fd);
+	if (!ok) {
+		throw exceptionhandler("could not sync " + dir + " (durablefile::syncdir)");
+	}
+#endif
+}
+
+void durablefile::replace(const string& temp, const string& path)
+{
+	syncfile(temp);
+#ifdef _WIN32
+	const bool ok = MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const bool ok = ::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+	if (!ok) {
+		throw exceptionhandler("could not replace " + path + " (durablefile::replace)");
+	}
+	syncdir(path);
+}
@@ -0,0 +1,15 @@
+//getting bytes onto the disk, not just into the os cache: fsync a finished
+//file, and swap a fully written temp file in over the real one so a crash
+//leaves either the old file or the new one, never half of either
+#pragma once
+#include <string>
+using namespace std;
+
+namespace durablefile {
+	//flushes a closed file's data to disk, throws exceptionhandler on failure
+	void syncfile(const string&);
+	//makes renames and creates in the directory holding the path durable
+	void syncdir(const string&);
+	//syncfile(temp), rename temp over path, syncdir(path)
+	void replace(const string& temp, const string& path);
+}
@@ -0,0 +1,172 @@
+#include "eligibility.h"
+#include "DojoManager.h"
+#include "rostershards.h"
+#include "attendance.h"
+#include "rankrules.h"
+#include "exceptionhandler.h"
+#include <algorithm>
+using namespace std;
+
+namespace {
+	const int defaultsessions = 24;
+	const int defaultwindow = 90;
+	//rows pulled out of the roster per pass, keeps the columns in cache
+	const int blockrows = 4096;
+
+	double ratio(int have, int need)
+	{
+		return need <= 0 ? static_cast<double>(have) + 1.0 : static_cast<double>(have) / need;
+	}
+}
+
+//next step up from each (rank, stripes) is the first month rankrules
+//places a student higher, nothing above black
+eligibility::eligibility() : rules(), window(defaultwindow)
+{
+	for (int s = 0; s < slotcount; ++s) {
+		rules[s].minmonths = -1;
+		rules[s].minsessions = defaultsessions;
+	}
+	for (int m = rankrules::lastmonth; m > 0; --m) {
+		const rankrules::placement before = rankrules::placementfor(m - 1);
+		const rankrules::placement after = rankrules::placementfor(m);
+		if (before.rank != after.rank || before.stripes != after.stripes) {
+			rules[slotof(before.rank, before.stripes)].minmonths = m;
+		}
+	}
+}
+
+void eligibility::require(StudentInfo::BeltRank rank, StudentInfo::BeltStripes stripes, const requirement& rule)
+{
+	rules[slotof(rank, stripes)] = rule;
+}
+
+void eligibility::requiresessions(StudentInfo::BeltRank rank, int sessions)
+{
+	for (int s = 0; s < stripecount; ++s) {
+		rules[slotof(rank, s)].minsessions = sessions;
+	}
+}
+
+const eligibility::requirement& eligibility::requirementfor(StudentInfo::BeltRank rank, StudentInfo::BeltStripes stripes) const
+{
+	return rules[slotof(rank, stripes)];
+}
+
+void eligibility::setwindow(int days)
+{
+	if (days <= 0) {
+		throw exceptionhandler("attendance window must be at least a day (eligibility::setwindow)");
+	}
+	window = days;
+}
+
+vector<eligibility::candidate> eligibility::evaluate(const DojoManager& roster, const attendance& log, int32_t today) const
+{
+	vector<candidate> result;
+	evaluateinto(roster, 0, log, today, result);
+	byreadiness(result);
+	return result;
+}
+
+vector<eligibility::candidate> eligibility::evaluate(const rostershards& shards, const attendance& log, int32_t today) const
+{
+	vector<candidate> result;
+	for (int s = 0; s < shards.shardcount(); ++s) {
+		evaluateinto(shards.shard(s), s, log, today, result);
+	}
+	byreadiness(result);
+	return result;
+}
+
+int eligibility::slotof(int rank, int stripes)
+{
+	if (rank < 0 || rank > StudentInfo::Black || stripes < 0 || stripes >= stripecount) {
+		throw exceptionhandler("rank or stripes out of range (eligibility)");
+	}
+	return rank * stripecount + stripes;
+}
+
+//months first over packed columns (a table gather and a compare per row,
+//no branches), attendance popcounts only for the rows that got through
+void eligibility::evaluateinto(const DojoManager& roster, int shard, const attendance& log, int32_t today,
+	vector<candidate>& out) const
+{
+	//one extra slot past the real ones for a rank or stripe count out of
+	//range (bad bytes from a save), it never passes and is never indexed past
+	int32_t needmonths[slotcount + 1];
+	int32_t needsessions[slotcount + 1];
+	for (int s = 0; s < slotcount; ++s) {
+		//a slot with nothing to test for can never pass the months compare
+		needmonths[s] = rules[s].minmonths < 0 ? INT32_MAX : rules[s].minmonths;
+		needsessions[s] = rules[s].minsessions;
+	}
+	needmonths[slotcount] = INT32_MAX;
+	needsessions[slotcount] = INT32_MAX;
+	const int32_t from = today - window + 1;
+
+	vector<int32_t> months(blockrows);
+	vector<uint8_t> slots(blockrows);
+	vector<uint8_t> passed(blockrows);
+	vector<uint32_t> ids;
+	vector<int> rows;
+	vector<int> sessions;
+	const int n = roster.getsize();
+	for (int first = 0; first < n; first += blockrows) {
+		const int count = min(blockrows, n - first);
+		for (int i = 0; i < count; ++i) {
+			const StudentInfo* cur = roster.getind(first + i);
+			months[i] = cur->getMonths();
+			const unsigned int rank = static_cast<unsigned int>(cur->getRank());
+			const unsigned int stripes = static_cast<unsigned int>(cur->getStripes());
+			const bool valid = rank <= StudentInfo::Black && stripes < static_cast<unsigned int>(stripecount);
+			slots[i] = static_cast<uint8_t>(valid ? rank * stripecount + stripes : slotcount);
+		}
+		for (int i = 0; i < count; ++i) {
+			passed[i] = months[i] >= needmonths[slots[i]];
+		}
+
+		ids.clear();
+		rows.clear();
+		for (int i = 0; i < count; ++i) {
+			if (passed[i]) {
+				rows.push_back(i);
+				ids.push_back(roster.getind(first + i)->getid());
+			}
+		}
+		sessions.resize(ids.size());
+		log.counts(ids.data(), ids.size(), from, today, sessions.data());
+
+		for (size_t c = 0; c < rows.size(); ++c) {
+			const int i = rows[c];
+			const int slot = slots[i];
+			if (sessions[c] < needsessions[slot]) {
+				continue;
+			}
+			candidate pick;
+			pick.id = ids[c];
+			pick.shard = shard;
+			pick.index = first + i;
+			pick.months = months[i];
+			pick.sessions = sessions[c];
+			pick.rank = static_cast<StudentInfo::BeltRank>(slot / stripecount);
+			pick.stripes = static_cast<StudentInfo::BeltStripes>(slot % stripecount);
+			pick.readiness = min(ratio(months[i], needmonths[slot]), ratio(sessions[c], needsessions[slot]));
+			out.push_back(pick);
+		}
+	}
+}
+
+//most ready first, ties by shard and roster order so runs are repeatable
+void eligibility::byreadiness(vector<candidate>& list)
+{
+	std::sort(list.begin(), list.end(), [](const candidate& a, const candidate& b) {
+		if (a.readiness != b.readiness) {
+			return a.readiness > b.readiness;
+		}
+		if (a.shard != b.shard) {
+			return a.shard < b.shard;
+		}
+		return a.index < b.index;
+	});
+}
@@ -0,0 +1,56 @@
+//weekly belt test planning: who has the months enrolled and the recent
+//attendance to test for their next stripe (or belt). requirements are set
+//per rank and stripe, the defaults follow rankrules and ask for 24 classes
+//in the last 90 days. results come back most ready first
+#pragma once
+#include "StudentInfo.h"
+#include <vector>
+#include <cstdint>
+using namespace std;
+class DojoManager;
+class rostershards;
+class attendance;
+
+class eligibility
+{
+public:
+	struct requirement {
+		int minmonths; //months enrolled, below 0 = nothing to test for
+		int minsessions; //classes attended in the window
+	};
+
+	struct candidate {
+		uint32_t id; //StudentInfo::getid()
+		int shard; //0 for a single roster
+		int index; //roster index in that shard
+		int months;
+		int sessions;
+		StudentInfo::BeltRank rank;
+		StudentInfo::BeltStripes stripes;
+		//the weaker of months / minmonths and sessions / minsessions, 1 = just made it
+		double readiness;
+	};
+
+	eligibility();
+
+	void require(StudentInfo::BeltRank, StudentInfo::BeltStripes, const requirement&);
+	//same class count for every stripe of a rank
+	void requiresessions(StudentInfo::BeltRank, int);
+	const requirement& requirementfor(StudentInfo::BeltRank, StudentInfo::BeltStripes) const;
+	//attendance window in days, ending on the day passed to evaluate
+	void setwindow(int);
+
+	vector<candidate> evaluate(const DojoManager&, const attendance&, int32_t) const;
+	//every location, merged and sorted together
+	vector<candidate> evaluate(const rostershards&, const attendance&, int32_t) const;
+
+private:
+	static const int stripecount = StudentInfo::four + 1;
+	static const int slotcount = (StudentInfo::Black + 1) * stripecount;
+	requirement rules[slotcount];
+	int window;
+
+	static int slotof(int, int);
+	void evaluateinto(const DojoManager&, int, const attendance&, int32_t, vector<candidate>&) const;
+	static void byreadiness(vector<candidate>&);
+};
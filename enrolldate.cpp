@@ -0,0 +1,141 @@
+#include "enrolldate.h"
+#include <ctime>
+using namespace std;
+
+namespace {
+	static_assert(enrolldate::fromcivil(1970, 1, 1) == 0, "day numbers start at 01/01/1970");
+	static_assert(enrolldate::fromcivil(2000, 3, 1) - enrolldate::fromcivil(2000, 2, 28) == 2, "2000 is a leap year");
+
+	bool isnumeral(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	void skipspaces(const char*& at, const char* end)
+	{
+		while (at < end && *at == ' ') {
+			++at;
+		}
+	}
+
+	//reads between least and most digits, -1 if there aren't enough
+	int readnumber(const char*& at, const char* end, int least, int most)
+	{
+		int value = 0;
+		int digits = 0;
+		while (at < end && digits < most && isnumeral(*at)) {
+			value = value * 10 + (*at - '0');
+			++at;
+			++digits;
+		}
+		return digits >= least ? value : -1;
+	}
+
+	bool readslash(const char*& at, const char* end)
+	{
+		skipspaces(at, end);
+		if (at == end || *at != '/') {
+			return false;
+		}
+		++at;
+		skipspaces(at, end);
+		return true;
+	}
+
+	int daysin(int year, int month)
+	{
+		static const int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+		const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		return month == 2 && leap ? 29 : days[month - 1];
+	}
+}
+
+int32_t enrolldate::parse(string_view text)
+{
+	const char* at = text.data();
+	const char* end = at + text.size();
+	skipspaces(at, end);
+	const int month = readnumber(at, end, 1, 2);
+	if (month < 1 || month > 12 || !readslash(at, end)) {
+		return invalid;
+	}
+	const int day = readnumber(at, end, 1, 2);
+	if (day < 1 || !readslash(at, end)) {
+		return invalid;
+	}
+	const int year = readnumber(at, end, 4, 4);
+	skipspaces(at, end);
+	if (year < 0 || at != end || day > daysin(year, month)) {
+		return invalid;
+	}
+	return fromcivil(year, month, day);
+}
+
+string enrolldate::format(int32_t days)
+{
+	if (days == invalid) {
+		return string();
+	}
+	int year, month, day;
+	tocivil(days, year, month, day);
+	char text[] = "MM/DD/YYYY";
+	text[0] = static_cast<char>('0' + month / 10);
+	text[1] = static_cast<char>('0' + month % 10);
+	text[3] = static_cast<char>('0' + day / 10);
+	text[4] = static_cast<char>('0' + day % 10);
+	for (int i = 9; i >= 6; --i) {
+		text[i] = static_cast<char>('0' + year % 10);
+		year /= 10;
+	}
+	return string(text, 10);
+}
+
+void enrolldate::tocivil(int32_t days, int& year, int& month, int& day)
+{
+	const int z = days + 719468;
+	const int era = (z >= 0 ? z : z - 146096) / 146097;
+	const int doe = z - era * 146097;
+	const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const int mp = (5 * doy + 2) / 153;
+	day = doy - (153 * mp + 2) / 5 + 1;
+	month = mp < 10 ? mp + 3 : mp - 9;
+	year = yoe + era * 400 + (month <= 2);
+}
+
+int32_t enrolldate::today()
+{
+	time_t t = time(0);
+	struct tm now;
+#ifdef _WIN32
+	localtime_s(&now, &t);
+#else
+	localtime_r(&t, &now);
+#endif
+	return fromcivil(now.tm_year + 1900, now.tm_mon + 1, now.tm_mday);
+}
+
+int enrolldate::monthsbetween(int32_t start, int32_t now)
+{
+	const int months = yearmonth(now) - yearmonth(start);
+	return months < 0 ? 0 : months;
+}
+
+void enrolldate::monthsenrolled(const int32_t* starts, int* months, size_t n, int32_t now)
+{
+	const int current = yearmonth(now);
+	for (size_t i = 0; i < n; ++i) {
+		if (starts[i] != invalid) {
+			const int elapsed = current - yearmonth(starts[i]);
+			months[i] = elapsed < 0 ? 0 : elapsed;
+		}
+	}
+}
+
+//year * 12 + month, enough to subtract calendar months
+int enrolldate::yearmonth(int32_t days)
+{
+	int year, month, day;
+	tocivil(days, year, month, day);
+	return year * 12 + month;
+}
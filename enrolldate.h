@@ -0,0 +1,42 @@
+//start dates packed as day numbers (days since 01/01/1970) so nightly
+//enrollment refreshes are integer math against one clock reading instead of
+//a stringstream and localtime per student
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+class enrolldate
+{
+public:
+	static const int32_t invalid = INT32_MIN;
+
+	//"MM/DD/YYYY", one digit months/days and spaces around the slashes are
+	//fine, anything else (or a day the month doesn't have) is invalid
+	static int32_t parse(string_view);
+	static string format(int32_t);
+
+	static constexpr int32_t fromcivil(int year, int month, int day) {
+		//March based years put the leap day last, 400 year eras repeat
+		const int y = year - (month <= 2);
+		const int era = (y >= 0 ? y : y - 399) / 400;
+		const int yoe = y - era * 400;
+		const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+		const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+		return era * 146097 + doe - 719468;
+	}
+	static void tocivil(int32_t, int&, int&, int&);
+
+	//local date, read the clock once and pass it to a whole batch
+	static int32_t today();
+
+	//calendar months from start to now (days of the month don't count), never negative
+	static int monthsbetween(int32_t, int32_t);
+	//months[i] = monthsbetween(starts[i], now), invalid starts leave months[i] as is
+	static void monthsenrolled(const int32_t*, int*, size_t, int32_t);
+
+private:
+	static int yearmonth(int32_t);
+};
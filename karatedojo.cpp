@@ -1,6 +1,10 @@
 //backbone of the code
 #include "karatedojo.h"
 #include "StudentInfo.h"
+#include "reportwriter.h"
+#include "beltnames.h"
+#include "rankrules.h"
+#include "exceptionhandler.h"
 
 #include <iostream>
 #include <string>
@@ -93,39 +97,9 @@ void karatedojo::addStudent() { //adding new student function
 		newStudent.stripes = zero;
 	}
 	newStudent.monthsEnrolled = inputsys.inputint("Months Enrolled? 1 or greater: ");
-	if (newStudent.monthsEnrolled <= 5) {
-		newStudent.rank = White;
-		//work on stripes system
-		newStudent.stripes = two;
-	}
-	else if (newStudent.monthsEnrolled > 6 && newStudent.monthsEnrolled <= 11) {
-		newStudent.rank = Yellow;
-		newStudent.stripes = two;
-	}
-	else if (newStudent.monthsEnrolled > 12 && newStudent.monthsEnrolled <= 17) {
-		newStudent.rank = Green;
-		newStudent.stripes = two;
-	}
-	else if (newStudent.monthsEnrolled > 18 && newStudent.monthsEnrolled <= 23) {
-		newStudent.rank = Blue;
-		newStudent.stripes = two;
-	}
-	else if (newStudent.monthsEnrolled > 24 && newStudent.monthsEnrolled <= 29) {
-		newStudent.rank = Purple;
-		newStudent.stripes = two;
-	}
-	else if (newStudent.monthsEnrolled > 30 && newStudent.monthsEnrolled <= 35) {
-		newStudent.rank = Brown;
-		newStudent.stripes = two;
-	}
-	else if (newStudent.monthsEnrolled >= 36) {
-		newStudent.rank = Black;
-		newStudent.stripes = zero;
-	}
-	else {
-		newStudent.rank = White;
-		newStudent.stripes = zero;
-	}
+	const rankrules::placement placed = rankrules::placementfor(newStudent.monthsEnrolled);
+	newStudent.rank = static_cast<BeltRank>(placed.rank);
+	newStudent.stripes = static_cast<BeltStripes>(placed.stripes);
 	newStudent.needsGear = inputsys.inputbool("Needs? (true or false): ");
 	newStudent.Contact = inputsys.inputname("Emergency Contact: ");
 
@@ -146,52 +120,8 @@ void karatedojo::displayregistration() //Displaying the reg with setw functions
 		<< setw(10) << "Emergency Contact" << endl;
 
 	for (int i = 0; i < registration_size; ++i) {
-		string belt;
-		string stripe;
-
-		if (inventory[i].rank == StudentInfo::White) {
-			belt = "White";
-		}
-		else if (inventory[i].rank == StudentInfo::Yellow) {
-			belt = "Yellow";
-		}
-		else if (inventory[i].rank == StudentInfo::Green) {
-			belt = "Green";
-		}
-		else if (inventory[i].rank == StudentInfo::Blue) {
-			belt = "Blue";
-		}
-		else if (inventory[i].rank == StudentInfo::Purple) {
-			belt = "Purple";
-		}
-		else if (inventory[i].rank == StudentInfo::Brown) {
-			belt = "Brown";
-		}
-		else if (inventory[i].rank == StudentInfo::Black) {
-			belt = "Black";
-		}
-		else {
-			belt = "Unknown";
-		}
-
-		if (inventory[i].stripes == StudentInfo::zero) {
-			stripe = "zero";
-		}
-		else if (inventory[i].stripes == StudentInfo::one) {
-			stripe = "one";
-		}
-		else if (inventory[i].stripes == StudentInfo::two) {
-			stripe = "two";
-		}
-		else if (inventory[i].stripes == StudentInfo::three) {
-			stripe = "three";
-		}
-		else if (inventory[i].stripes == StudentInfo::four) {
-			stripe = "four";
-		}
-		else {
-			stripe = "Unknown";
-		}
+		const string_view belt = beltnames::ranks.name(inventory[i].rank, "Unknown");
+		const string_view stripe = beltnames::stripes.lowername(inventory[i].stripes, "Unknown");
 		cout << left << setw(20) << inventory[i].name
 			<< setw(15) << inventory[i].age << setw(20) << belt
 			<< setw(15) << stripe << setw(10) << inventory[i].Contact;
@@ -203,76 +133,31 @@ void karatedojo::savereport() { //saving report to text file
 		cout << "The registration is empty. No report to save." << endl;
 		return;
 	}
-	ofstream reportfile("report.txt");
-	if (!reportfile) {
+	//rows used to go to cout by mistake, the file only ever got the headers
+	reportwriter report(reportwriter::text);
+	try {
+		report.open("report.txt");
+	}
+	catch (const exceptionhandler&) {
 		cout << "error creating the file." << endl;
 		return;
 	}
-	reportfile << "Registration Report" << endl;
-	reportfile << fixed << setprecision(2);
-	reportfile << left << setw(20) << "Name" << setw(15) << "Age"
-		<< setw(20) << "Belt Rank" << setw(15) << "Belt Stripes"
-		<< setw(10) << "Emergency Contact" << endl;
-	for (int i = 0; i < registration_size; ++i) {
-		string belt;
-		string stripe;
-
-		if (inventory[i].rank == StudentInfo::White) {
-			belt = "White";
-		}
-		else if (inventory[i].rank == StudentInfo::Yellow) {
-			belt = "Yellow";
-		}
-		else if (inventory[i].rank == StudentInfo::Green) {
-			belt = "Green";
-		}
-		else if (inventory[i].rank == StudentInfo::Blue) {
-			belt = "Blue";
-		}
-		else if (inventory[i].rank == StudentInfo::Purple) {
-			belt = "Purple";
-		}
-		else if (inventory[i].rank == StudentInfo::Brown) {
-			belt = "Brown";
-		}
-		else if (inventory[i].rank == StudentInfo::Black) {
-			belt = "Black";
-		}
-		else {
-			belt = "Unknown";
-		}
-
-		if (inventory[i].stripes == StudentInfo::zero) {
-			stripe = "zero";
-		}
-		else if (inventory[i].stripes == StudentInfo::one) {
-			stripe = "one";
-		}
-		else if (inventory[i].stripes == StudentInfo::two) {
-			stripe = "two";
-		}
-		else if (inventory[i].stripes == StudentInfo::three) {
-			stripe = "three";
-		}
-		else if (inventory[i].stripes == StudentInfo::four) {
-			stripe = "four";
-		}
-		else {
-			stripe = "Unknown";
-		}
-		cout << left << setw(20) << inventory[i].name
-			<< setw(15) << inventory[i].age << setw(20) << belt
-			<< setw(15) << stripe << setw(10) << inventory[i].Contact;
+	try {
+		report.header();
+		report.writerows(inventory, registration_size, 0);
+		report.close();
+	}
+	catch (const exceptionhandler& e) {
+		cout << "error writing the report: " << e.what() << endl;
+		return;
 	}
-	reportfile << endl;
-	reportfile.close();
 	cout << "Report created successfully." << endl;
 	cout << "Report saved to report.txt" << endl;
 }
 
 
-void karatedojo::print() const {
-	cout << "Karate registration size: " << registration_size << endl;
+void karatedojo::printto(ostream& output) const {
+	output << "Karate registration size: " << registration_size << '\n';
 }
 
 //Unit testing related functions
@@ -32,7 +32,7 @@ public:
 
 	int getregistrationsize() const;
 	
-	virtual void print() const override;
+	virtual void printto(ostream&) const override;
 
 	void additemtodirect(const StudentInfo::StudentInf& newStudent);
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+//windows.h before anything that says using namespace std, or its byte
+//clashes with std::byte under C++17; min/max macros are kept out too
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+#include "mappedfile.h"
+#include "exceptionhandler.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+#ifdef _WIN32
+mappedfile::mappedfile() : base(nullptr), length(0), filehandle(nullptr), maphandle(nullptr)
+{
+}
+#else
+mappedfile::mappedfile() : base(nullptr), length(0), fd(-1)
+{
+}
+#endif
+
+mappedfile::~mappedfile()
+{
+	close();
+}
+
+#ifdef _WIN32
+void mappedfile::open(const string& path)
+{
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw exceptionhandler("could not open " + path + " (mappedfile::open)");
+	}
+	LARGE_INTEGER filesize;
+	if (!GetFileSizeEx(file, &filesize)) {
+		CloseHandle(file);
+		throw exceptionhandler("could not size " + path + " (mappedfile::open)");
+	}
+	filehandle = file;
+	length = static_cast<size_t>(filesize.QuadPart);
+	if (length == 0) {
+		return; //nothing to map, data() stays null
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		close();
+		throw exceptionhandler("could not map " + path + " (mappedfile::open)");
+	}
+	maphandle = mapping;
+	base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!base) {
+		close();
+		throw exceptionhandler("could not map " + path + " (mappedfile::open)");
+	}
+}
+
+void mappedfile::close()
+{
+	if (base) {
+		UnmapViewOfFile(base);
+	}
+	if (maphandle) {
+		CloseHandle(static_cast<HANDLE>(maphandle));
+	}
+	if (filehandle) {
+		CloseHandle(static_cast<HANDLE>(filehandle));
+	}
+	base = nullptr;
+	length = 0;
+	maphandle = nullptr;
+	filehandle = nullptr;
+}
+
+bool mappedfile::isopen() const
+{
+	return filehandle != nullptr;
+}
+#else
+void mappedfile::open(const string& path)
+{
+	close();
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw exceptionhandler("could not open " + path + " (mappedfile::open)");
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close();
+		throw exceptionhandler("could not size " + path + " (mappedfile::open)");
+	}
+	length = static_cast<size_t>(info.st_size);
+	if (length == 0) {
+		return;
+	}
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapped == MAP_FAILED) {
+		close();
+		throw exceptionhandler("could not map " + path + " (mappedfile::open)");
+	}
+	base = static_cast<const char*>(mapped);
+}
+
+void mappedfile::close()
+{
+	if (base) {
+		munmap(const_cast<char*>(base), length);
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+	base = nullptr;
+	length = 0;
+	fd = -1;
+}
+
+bool mappedfile::isopen() const
+{
+	return fd >= 0;
+}
+#endif
+
+const char* mappedfile::data() const
+{
+	return base;
+}
+
+size_t mappedfile::size() const
+{
+	return length;
+}
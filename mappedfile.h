@@ -0,0 +1,33 @@
+//read only memory map of a whole file (mmap, or a file mapping on windows)
+#pragma once
+#include <string>
+#include <cstddef>
+using namespace std;
+
+class mappedfile
+{
+public:
+	mappedfile();
+	~mappedfile();
+
+	//throws exceptionhandler if the file can't be opened or mapped
+	void open(const string&);
+	void close();
+
+	bool isopen() const;
+	const char* data() const;
+	size_t size() const;
+
+private:
+	const char* base;
+	size_t length;
+#ifdef _WIN32
+	void* filehandle;
+	void* maphandle;
+#else
+	int fd;
+#endif
+
+	mappedfile(const mappedfile&);
+	mappedfile& operator=(const mappedfile&);
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <cstddef>
+using namespace std;
+
+//FNV-1a, cheap and spreads short names well, not meant to be secure
+struct namehash {
+	size_t operator()(const string& name) const {
+		unsigned long long h = 14695981039346656037ULL;
+		for (size_t i = 0; i < name.size(); ++i) {
+			h ^= static_cast<unsigned char>(name[i]);
+			h *= 1099511628211ULL;
+		}
+		return static_cast<size_t>(h);
+	}
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <new>
+using namespace std;
+
+//hands out T sized blocks carved from big slabs, freed blocks go on a free
+//list and are reused first, so nodes made one after another sit together
+template <typename T>
+class nodepool {
+private:
+    union cell {
+        cell* nextfree;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static const int slabsize = 1024;
+
+    vector<cell*> slabs;
+    cell* freelist;
+    int used; //cells handed out from the newest slab
+
+public:
+    nodepool() : slabs(), freelist(nullptr), used(slabsize) {}
+
+    ~nodepool() { release(); }
+
+    void* allocate() {
+        if (freelist) {
+            cell* c = freelist;
+            freelist = c->nextfree;
+            return c->storage;
+        }
+        if (used >= slabsize) {
+            slabs.push_back(static_cast<cell*>(::operator new(sizeof(cell) * slabsize)));
+            used = 0;
+        }
+        return slabs.back()[used++].storage;
+    }
+
+    void deallocate(void* p) {
+        cell* c = static_cast<cell*>(p);
+        c->nextfree = freelist;
+        freelist = c;
+    }
+
+    //drops every slab at once, only for T that needs no destructor
+    void release() {
+        for (size_t i = 0; i < slabs.size(); ++i) {
+            ::operator delete(slabs[i]);
+        }
+        slabs.clear();
+        freelist = nullptr;
+        used = slabsize;
+    }
+
+private:
+    nodepool(const nodepool&);
+    nodepool& operator=(const nodepool&);
+};
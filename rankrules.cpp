@@ -0,0 +1,34 @@
+#include "rankrules.h"
+#include "DojoManager.h"
+using namespace std;
+
+namespace rankrules {
+	static_assert(bandrank[bandcount - 1] == StudentInfo::Black, "rank table out of step with BeltRank");
+	static_assert(stripecount == StudentInfo::four + 1, "stripe count out of step with BeltStripes");
+
+	int rerank(DojoManager& roster)
+	{
+		int changed = 0;
+		const int n = roster.getsize();
+		for (int i = 0; i < n; ++i) {
+			StudentInfo* cur = roster.getind(i);
+			if (!cur) {
+				continue;
+			}
+			const placement p = placementfor(cur->getMonths());
+			const StudentInfo::BeltRank rank = static_cast<StudentInfo::BeltRank>(p.rank);
+			const StudentInfo::BeltStripes stripes = static_cast<StudentInfo::BeltStripes>(p.stripes);
+			//setters only for real changes, each one tells the roster's watchers
+			const bool rankmoved = cur->getRank() != rank;
+			const bool stripesmoved = cur->getStripes() != stripes;
+			if (rankmoved) {
+				cur->setRank(rank);
+			}
+			if (stripesmoved) {
+				cur->setStripes(stripes);
+			}
+			changed += (rankmoved || stripesmoved) ? 1 : 0;
+		}
+		return changed;
+	}
+}
@@ -0,0 +1,87 @@
+//promotion rules by months enrolled: one constexpr table shared by
+//recommendLevel, karatedojo::addStudent and the monthly rerank pass.
+//ranks move up every six months, stripes count progress through a band
+#pragma once
+#include <cstdint>
+#include <cstddef>
+class DojoManager;
+
+namespace rankrules {
+	//rank is a BeltRank value (White..Black), stripes a BeltStripes value (zero..four)
+	struct placement {
+		uint8_t rank;
+		uint8_t stripes;
+	};
+
+	inline constexpr int bandmonths = 6;
+	//rank for each six month band, 36-41 months is the black belt candidate
+	//stretch (still brown) and the last band is black from 42 months on
+	inline constexpr uint8_t bandrank[] = { 0, 1, 2, 3, 4, 5, 5, 6 };
+	inline constexpr int bandcount = sizeof(bandrank) / sizeof(bandrank[0]);
+	inline constexpr int lastmonth = (bandcount - 1) * bandmonths;
+	inline constexpr int stripecount = 5;
+
+	constexpr int clampmonths(int months) {
+		return months < 0 ? 0 : months > lastmonth ? lastmonth : months;
+	}
+
+	constexpr int bandof(int months) {
+		return clampmonths(months) / bandmonths;
+	}
+
+	struct placementgrid {
+		placement slot[lastmonth + 1];
+	};
+
+	constexpr placementgrid buildgrid() {
+		placementgrid g = {};
+		for (int m = 0; m <= lastmonth; ++m) {
+			const int band = m / bandmonths;
+			g.slot[m].rank = bandrank[band];
+			//zero..four across a band, black belts start over at zero and a
+			//band that keeps the rank before it (the candidate stretch) holds
+			//at four rather than starting over
+			if (band == bandcount - 1) {
+				g.slot[m].stripes = 0;
+			}
+			else if (band > 0 && bandrank[band] == bandrank[band - 1]) {
+				g.slot[m].stripes = stripecount - 1;
+			}
+			else {
+				g.slot[m].stripes = static_cast<uint8_t>((m % bandmonths) * stripecount / bandmonths);
+			}
+		}
+		return g;
+	}
+
+	inline constexpr placementgrid grid = buildgrid();
+
+	//ranks never go down, and stripes only go down when the rank goes up
+	constexpr bool onlymovesup() {
+		for (int m = 1; m <= lastmonth; ++m) {
+			const placement before = grid.slot[m - 1];
+			const placement after = grid.slot[m];
+			if (after.rank < before.rank || (after.rank == before.rank && after.stripes < before.stripes)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//clamp and index, no compares against each threshold
+	constexpr placement placementfor(int months) {
+		return grid.slot[clampmonths(months)];
+	}
+
+	static_assert(placementfor(5).rank == 0 && placementfor(6).rank == 1 && placementfor(12).rank == 2,
+		"every band boundary starts the next rank");
+	static_assert(placementfor(41).rank == 5 && placementfor(42).rank == 6 && placementfor(500).rank == 6,
+		"black belt from 42 months");
+	static_assert(placementfor(5).stripes == stripecount - 1, "a full band ends on the last stripe");
+	static_assert(placementfor(36).rank == 5 && placementfor(36).stripes == stripecount - 1,
+		"black belt candidates stay brown with four stripes");
+	static_assert(onlymovesup(), "more months never takes a rank or a stripe away");
+
+	//rank and stripes from months enrolled for every student, returns how many changed
+	int rerank(DojoManager&);
+}
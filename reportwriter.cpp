@@ -0,0 +1,339 @@
+#include "reportwriter.h"
+#include "DojoManager.h"
+#include "exceptionhandler.h"
+#include "beltnames.h"
+#include <charconv>
+#include <thread>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+namespace {
+	const size_t flushsize = 1 << 20;
+	const int shardrows = 16384;
+
+	//column widths of the old setw table
+	const size_t namewidth = 20;
+	const size_t agewidth = 15;
+	const size_t contactwidth = 10;
+
+	//labels already padded to the table width, picked by enum value
+	constexpr auto paddedranks = beltnames::ranks.padded<20>(false);
+	constexpr auto paddedstripes = beltnames::stripes.padded<15>(true);
+	static_assert(beltnames::ranks.longest() < 20 && beltnames::stripes.longest() < 15, "belt label wider than its column");
+	const string_view unknownrank = "Unknown             ";
+	const string_view unknownstripe = "Unknown        ";
+
+	const char spaces[] = "                    ";
+
+	void pad(string& out, size_t used, size_t width) {
+		if (used < width) {
+			out.append(spaces, width - used);
+		}
+	}
+
+	void appendint(string& out, int value) {
+		char digits[16];
+		to_chars_result r = to_chars(digits, digits + sizeof(digits), value);
+		out.append(digits, r.ptr);
+	}
+
+	string_view rankname(StudentInfo::BeltRank rank, bool padded) {
+		if (rank < StudentInfo::White || rank > StudentInfo::Black) {
+			return padded ? unknownrank : string_view("Unknown");
+		}
+		return padded ? paddedranks.at(rank) : beltnames::ranks.name(rank);
+	}
+
+	//reports always spelled stripes in lower case
+	string_view stripename(StudentInfo::BeltStripes stripes, bool padded) {
+		if (stripes < StudentInfo::zero || stripes > StudentInfo::four) {
+			return padded ? unknownstripe : string_view("Unknown");
+		}
+		return padded ? paddedstripes.at(stripes) : beltnames::stripes.lowername(stripes);
+	}
+
+	void appendcsv(string& out, string_view field) {
+		if (field.find_first_of(",\"\n\r") == string_view::npos) {
+			out.append(field);
+			return;
+		}
+		out += '"';
+		for (size_t i = 0; i < field.size(); ++i) {
+			if (field[i] == '"') {
+				out += '"';
+			}
+			out += field[i];
+		}
+		out += '"';
+	}
+
+	void appendjson(string& out, string_view field) {
+		static const char hex[] = "0123456789abcdef";
+		out += '"';
+		for (size_t i = 0; i < field.size(); ++i) {
+			const unsigned char c = static_cast<unsigned char>(field[i]);
+			if (c == '"' || c == '\\') {
+				out += '\\';
+				out += static_cast<char>(c);
+			}
+			else if (c < 0x20) {
+				out.append("\\u00");
+				out += hex[c >> 4];
+				out += hex[c & 0xF];
+			}
+			else {
+				out += static_cast<char>(c);
+			}
+		}
+		out += '"';
+	}
+}
+
+reportwriter::reportwriter(mode m) : format(m), out(), path(), buffer(), rows(0)
+{
+	buffer.reserve(flushsize + 256);
+}
+
+reportwriter::~reportwriter()
+{
+	//a failed write was already reported by whoever flushed or closed last
+	try {
+		close();
+	}
+	catch (const exceptionhandler&) {
+	}
+}
+
+void reportwriter::open(const string& file)
+{
+	close();
+	//the table is a text file like savereport always wrote (crlf on windows),
+	//csv and json keep plain \n so they read back the same everywhere
+	const ios::openmode how = (format == text) ? ios::out | ios::trunc : ios::out | ios::binary | ios::trunc;
+	out.clear();
+	out.open(file.c_str(), how);
+	if (!out) {
+		throw exceptionhandler("could not create " + file + " (reportwriter::open)");
+	}
+	path = file;
+	rows = 0;
+}
+
+void reportwriter::close()
+{
+	if (!out.is_open()) {
+		return;
+	}
+	try {
+		flush();
+	}
+	catch (const exceptionhandler&) {
+		out.close();
+		throw;
+	}
+	out.close();
+	if (!out) {
+		throw exceptionhandler("could not write " + path + " (reportwriter::close)");
+	}
+}
+
+void reportwriter::header()
+{
+	formatheader(buffer, format);
+}
+
+void reportwriter::row(const StudentInfo::StudentInf& s)
+{
+	formatrow(buffer, format, s.name, s.age, s.isReturning, s.monthsEnrolled, s.rank, s.stripes, s.needsGear, s.Contact);
+	++rows;
+	flushifbig();
+}
+
+void reportwriter::row(const StudentInfo& s)
+{
+	formatrow(buffer, format, s.getName(), s.getAge(), s.getReturning(), s.getMonths(),
+		s.getRank(), s.getStripes(), s.getGear(), s.getContact());
+	++rows;
+	flushifbig();
+}
+
+void reportwriter::writeroster(const DojoManager& roster)
+{
+	const int n = roster.getsize();
+	for (int i = 0; i < n; ++i) {
+		const StudentInfo* cur = roster.getind(i);
+		if (cur) {
+			row(*cur);
+		}
+	}
+}
+
+void reportwriter::writeroster(const DojoManager& roster, int threads)
+{
+	const mode m = format;
+	sharded(roster.getsize(), threads, [&roster, m](string& dest, int i) {
+		const StudentInfo* cur = roster.getind(i);
+		if (!cur) {
+			return false;
+		}
+		formatrow(dest, m, cur->getName(), cur->getAge(), cur->getReturning(), cur->getMonths(),
+			cur->getRank(), cur->getStripes(), cur->getGear(), cur->getContact());
+		return true;
+	});
+}
+
+void reportwriter::writerows(const StudentInfo::StudentInf* students, int n, int threads)
+{
+	const mode m = format;
+	sharded(n, threads, [students, m](string& dest, int i) {
+		const StudentInfo::StudentInf& s = students[i];
+		formatrow(dest, m, s.name, s.age, s.isReturning, s.monthsEnrolled, s.rank, s.stripes, s.needsGear, s.Contact);
+		return true;
+	});
+}
+
+//each wave hands one shard to each thread, then writes the finished
+//buffers in order, so memory stays at threads * shard no matter the size
+template <typename Format>
+void reportwriter::sharded(int n, int threads, Format formatone)
+{
+	if (threads <= 0) {
+		threads = static_cast<int>(thread::hardware_concurrency());
+	}
+	if (threads <= 1 || n <= shardrows) {
+		for (int i = 0; i < n; ++i) {
+			if (formatone(buffer, i)) {
+				++rows;
+				flushifbig();
+			}
+		}
+		return;
+	}
+
+	flush();
+	vector<string> shards(threads);
+	vector<int> counts(threads, 0);
+	for (int first = 0; first < n; first += threads * shardrows) {
+		vector<thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			const int begin = first + t * shardrows;
+			const int end = min(n, begin + shardrows);
+			shards[t].clear();
+			counts[t] = 0;
+			if (begin >= end) {
+				continue;
+			}
+			workers.push_back(thread([&shards, &counts, &formatone, t, begin, end]() {
+				string& dest = shards[t];
+				for (int i = begin; i < end; ++i) {
+					if (formatone(dest, i)) {
+						++counts[t];
+					}
+				}
+			}));
+		}
+		for (size_t w = 0; w < workers.size(); ++w) {
+			workers[w].join();
+		}
+		for (int t = 0; t < threads; ++t) {
+			write(shards[t]);
+			rows += counts[t];
+		}
+	}
+}
+
+void reportwriter::flush()
+{
+	write(buffer);
+	buffer.clear();
+}
+
+void reportwriter::write(const string& chunk)
+{
+	if (chunk.empty() || !out.is_open()) {
+		return;
+	}
+	out.write(chunk.data(), static_cast<streamsize>(chunk.size()));
+	if (!out.flush()) {
+		throw exceptionhandler("could not write " + path + " (reportwriter)");
+	}
+}
+
+int reportwriter::getrows() const
+{
+	return rows;
+}
+
+void reportwriter::flushifbig()
+{
+	if (buffer.size() >= flushsize) {
+		flush();
+	}
+}
+
+void reportwriter::formatheader(string& out, mode m)
+{
+	switch (m) {
+	case csv:
+		out.append("name,age,returning,months,rank,stripes,needsgear,contact\n");
+		break;
+	case json:
+		break; //every line stands on its own
+	case text:
+	default:
+		out.append("Registration Report\n");
+		out.append("Name                Age            Belt Rank           Belt Stripes   Emergency Contact\n");
+		break;
+	}
+}
+
+void reportwriter::formatrow(string& out, mode m, string_view name, int age, bool returning, int months,
+	StudentInfo::BeltRank rank, StudentInfo::BeltStripes stripes, bool needsgear, string_view contact)
+{
+	switch (m) {
+	case csv:
+		appendcsv(out, name);
+		out += ',';
+		appendint(out, age);
+		out.append(returning ? ",true," : ",false,");
+		appendint(out, months);
+		out += ',';
+		out.append(rankname(rank, false));
+		out += ',';
+		out.append(stripename(stripes, false));
+		out.append(needsgear ? ",true," : ",false,");
+		appendcsv(out, contact);
+		out += '\n';
+		break;
+	case json:
+		out.append("{\"name\":");
+		appendjson(out, name);
+		out.append(",\"age\":");
+		appendint(out, age);
+		out.append(returning ? ",\"returning\":true,\"months\":" : ",\"returning\":false,\"months\":");
+		appendint(out, months);
+		out.append(",\"rank\":\"");
+		out.append(rankname(rank, false));
+		out.append("\",\"stripes\":\"");
+		out.append(stripename(stripes, false));
+		out.append(needsgear ? "\",\"needsgear\":true,\"contact\":" : "\",\"needsgear\":false,\"contact\":");
+		appendjson(out, contact);
+		out.append("}\n");
+		break;
+	case text:
+	default: {
+		out.append(name);
+		pad(out, name.size(), namewidth);
+		const size_t before = out.size();
+		appendint(out, age);
+		pad(out, out.size() - before, agewidth);
+		out.append(rankname(rank, true));
+		out.append(stripename(stripes, true));
+		out.append(contact);
+		pad(out, contact.size(), contactwidth);
+		out += '\n';
+		break;
+	}
+	}
+}
@@ -0,0 +1,59 @@
+//registration report output: rows are formatted into one big buffer with
+//to_chars and pre-padded labels, and the buffer goes out in single writes
+#pragma once
+#include "StudentInfo.h"
+#include <string>
+#include <string_view>
+#include <fstream>
+using namespace std;
+class DojoManager;
+
+class reportwriter
+{
+public:
+	enum mode {
+		text, //the setw table savereport always printed
+		csv, //same columns and order rosterimport reads
+		json //one object per line, also readable by rosterimport
+	};
+
+	reportwriter(mode = text);
+	~reportwriter();
+
+	//throws exceptionhandler if the file can't be created
+	void open(const string&);
+	//flush() and close() throw exceptionhandler if the data didn't make it out
+	void close();
+
+	void header();
+	void row(const StudentInfo::StudentInf&);
+	void row(const StudentInfo&);
+	void writeroster(const DojoManager&);
+	//big rosters get split into shards formatted on worker threads and
+	//written back in roster order, 0 threads = one per core
+	void writeroster(const DojoManager&, int);
+	void writerows(const StudentInfo::StudentInf*, int, int);
+	void flush();
+
+	int getrows() const;
+
+	//formatting on its own so other code can fill its own buffers
+	static void formatheader(string&, mode);
+	static void formatrow(string&, mode, string_view, int, bool, int,
+		StudentInfo::BeltRank, StudentInfo::BeltStripes, bool, string_view);
+
+private:
+	mode format;
+	ofstream out;
+	string path;
+	string buffer;
+	int rows;
+
+	void write(const string&);
+	void flushifbig();
+	template <typename Format>
+	void sharded(int, int, Format);
+
+	reportwriter(const reportwriter&);
+	reportwriter& operator=(const reportwriter&);
+};
@@ -0,0 +1,395 @@
+#include "rostercheckpoint.h"
+#include "rostersnapshot.h"
+#include "dojostudent.h"
+#include "exceptionhandler.h"
+#include "durablefile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+using namespace std;
+
+namespace {
+	const char deltamagic[8] = { 'D', 'O', 'J', 'O', 'D', 'E', 'L', 'T' };
+	const uint32_t deltaversion = 2;
+	//version 1 headers stop before nextid
+	const size_t version1header = 32;
+	const char deltainfix[] = ".delta.";
+
+	string readfile(const string& path)
+	{
+		ifstream in(path.c_str(), ios::binary);
+		if (!in) {
+			throw exceptionhandler("could not open " + path + " (rostercheckpoint)");
+		}
+		return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	}
+
+	void setfields(StudentInfo* cur, const string& name, const string& contact, const rostersnapshot::record& rec)
+	{
+		cur->setName(name);
+		cur->setContact(contact);
+		cur->setAge(rec.age);
+		cur->setMonths(rec.months);
+		cur->setRank(static_cast<StudentInfo::BeltRank>(rec.rank));
+		cur->setStripes(static_cast<StudentInfo::BeltStripes>(rec.stripes));
+		cur->setGear(rec.needsgear != 0);
+		cur->setReturning(rec.returning != 0);
+	}
+}
+
+rostercheckpoint::rostercheckpoint() : roster(nullptr), basepath(), nextdelta(1), dirty(),
+	tombstones(), compactor(), busy(false), compacterror()
+{
+}
+
+rostercheckpoint::~rostercheckpoint()
+{
+	close();
+	if (compactor.joinable()) {
+		compactor.join();
+	}
+}
+
+void rostercheckpoint::open(const string& base, DojoManager& target)
+{
+	close();
+	if (target.getsize() != 0) {
+		throw exceptionhandler("roster must be empty (rostercheckpoint::open)");
+	}
+	restore(base, numeric_limits<uint32_t>::max(), target);
+
+	basepath = base;
+	dirty.clear();
+	tombstones.clear();
+	const vector<uint32_t> deltas = deltasof(base);
+	nextdelta = deltas.empty() ? 1 : deltas.back() + 1;
+
+	roster = &target;
+	roster->addlistener(this);
+}
+
+void rostercheckpoint::close()
+{
+	if (roster) {
+		roster->removelistener(this);
+		roster = nullptr;
+	}
+}
+
+int rostercheckpoint::checkpoint()
+{
+	if (!roster) {
+		throw exceptionhandler("nothing open (rostercheckpoint::checkpoint)");
+	}
+	if (dirty.empty() && tombstones.empty()) {
+		return 0;
+	}
+
+	deltaheader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, deltamagic, sizeof(deltamagic));
+	head.version = deltaversion;
+	head.recordsize = sizeof(rostersnapshot::record);
+	head.count = static_cast<uint32_t>(dirty.size());
+	head.tombstones = static_cast<uint32_t>(tombstones.size());
+	head.nextid = roster->getnextid();
+
+	//oldest id first so students added since the last checkpoint come back
+	//in the order they were added
+	vector<pair<uint32_t, const StudentInfo*>> changes;
+	changes.reserve(dirty.size());
+	for (unordered_set<const StudentInfo*>::const_iterator it = dirty.begin(); it != dirty.end(); ++it) {
+		changes.push_back(make_pair(static_cast<uint32_t>((*it)->getid()), *it));
+	}
+	std::sort(changes.begin(), changes.end());
+
+	string records;
+	string strings;
+	records.reserve(changes.size() * sizeof(rostersnapshot::record));
+	for (size_t c = 0; c < changes.size(); ++c) {
+		const StudentInfo* cur = changes[c].second;
+		rostersnapshot::record rec;
+		memset(&rec, 0, sizeof(rec));
+		rec.nameoffset = static_cast<uint32_t>(strings.size());
+		rec.namelength = static_cast<uint32_t>(cur->getName().size());
+		strings.append(cur->getName());
+		rec.contactoffset = static_cast<uint32_t>(strings.size());
+		rec.contactlength = static_cast<uint32_t>(cur->getContact().size());
+		strings.append(cur->getContact());
+		rec.age = cur->getAge();
+		rec.months = cur->getMonths();
+		rec.rank = static_cast<uint8_t>(cur->getRank());
+		rec.stripes = static_cast<uint8_t>(cur->getStripes());
+		rec.needsgear = cur->getGear() ? 1 : 0;
+		rec.returning = cur->getReturning() ? 1 : 0;
+		rec.id = changes[c].first;
+		records.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+	}
+	head.stringssize = strings.size();
+
+	//written aside, synced, then renamed and the directory synced, so a
+	//crash or power cut leaves either no delta or the whole of it
+	const string path = deltapath(basepath, nextdelta);
+	const string temp = path + ".tmp";
+	{
+		ofstream out(temp.c_str(), ios::binary | ios::trunc);
+		out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+		out.write(records.data(), static_cast<streamsize>(records.size()));
+		out.write(reinterpret_cast<const char*>(tombstones.data()),
+			static_cast<streamsize>(tombstones.size() * sizeof(uint32_t)));
+		out.write(strings.data(), static_cast<streamsize>(strings.size()));
+		out.close();
+		if (!out) {
+			throw exceptionhandler("could not write " + temp + " (rostercheckpoint::checkpoint)");
+		}
+	}
+	durablefile::replace(temp, path);
+
+	++nextdelta;
+	const int written = static_cast<int>(head.count + head.tombstones);
+	dirty.clear();
+	tombstones.clear();
+	return written;
+}
+
+int rostercheckpoint::dirtycount() const
+{
+	return static_cast<int>(dirty.size() + tombstones.size());
+}
+
+void rostercheckpoint::startcompaction()
+{
+	if (busy || basepath.empty() || nextdelta == 1) {
+		return;
+	}
+	if (compactor.joinable()) {
+		compactor.join();
+	}
+	//a failed run nobody waited on is reported here, not dropped
+	if (!compacterror.empty()) {
+		const string message = compacterror;
+		compacterror.clear();
+		throw exceptionhandler("last compaction failed: " + message + " (rostercheckpoint::startcompaction)");
+	}
+	busy = true;
+	//deltas written after this point are left for the next compaction
+	const string base = basepath;
+	const uint32_t upto = nextdelta - 1;
+	compactor = thread([this, base, upto]() {
+		try {
+			compactfiles(base, upto);
+		}
+		catch (const exception& e) {
+			compacterror = e.what();
+		}
+		busy = false;
+	});
+}
+
+void rostercheckpoint::waitcompaction()
+{
+	if (compactor.joinable()) {
+		compactor.join();
+	}
+	if (!compacterror.empty()) {
+		const string message = compacterror;
+		compacterror.clear();
+		throw exceptionhandler(message + " (rostercheckpoint::waitcompaction)");
+	}
+}
+
+bool rostercheckpoint::compacting() const
+{
+	return busy;
+}
+
+void rostercheckpoint::restore(const string& base, uint32_t upto, DojoManager& target)
+{
+	unordered_map<uint32_t, StudentInfo*> byid;
+	unordered_set<StudentInfo*> removed;
+
+	if (filesystem::exists(base)) {
+		rostersnapshot snap;
+		snap.open(base);
+		const int n = snap.size();
+		byid.reserve(n);
+		for (int i = 0; i < n; ++i) {
+			const rostersnapshot::record& rec = snap.at(i);
+			StudentInfo* cur = new dojostudent(snap.name(i), rec.age, rec.returning != 0, rec.months,
+				static_cast<StudentInfo::BeltRank>(rec.rank), static_cast<StudentInfo::BeltStripes>(rec.stripes),
+				rec.needsgear != 0, snap.contact(i));
+			//a snapshot saved without ids numbers its students by position
+			cur->setid(rec.id ? rec.id : static_cast<uint32_t>(i + 1));
+			target += cur;
+			byid[cur->getid()] = cur;
+		}
+		target.reserveids(snap.nextid());
+	}
+
+	const vector<uint32_t> deltas = deltasof(base);
+	for (size_t d = 0; d < deltas.size() && deltas[d] <= upto; ++d) {
+		applydelta(deltapath(base, deltas[d]), target, byid, removed);
+	}
+
+	//tombstoned students go in one sweep from the back
+	if (!removed.empty()) {
+		for (int i = target.getsize() - 1; i >= 0; --i) {
+			if (removed.count(target.getind(i))) {
+				target -= i;
+			}
+		}
+	}
+}
+
+//a student in a delta replaces whatever the id held before, so replaying a
+//delta the base already contains changes nothing
+void rostercheckpoint::applydelta(const string& path, DojoManager& target,
+	unordered_map<uint32_t, StudentInfo*>& byid, unordered_set<StudentInfo*>& removed)
+{
+	const string data = readfile(path);
+	deltaheader head;
+	memset(&head, 0, sizeof(head));
+	if (data.size() < version1header) {
+		throw exceptionhandler(path + " is not a roster delta (rostercheckpoint)");
+	}
+	memcpy(&head, data.data(), version1header);
+	if (memcmp(head.magic, deltamagic, sizeof(deltamagic)) != 0 || head.version < 1 || head.version > deltaversion
+		|| head.recordsize != sizeof(rostersnapshot::record)) {
+		throw exceptionhandler(path + " is not a roster delta or has an unknown version (rostercheckpoint)");
+	}
+	const size_t headsize = head.version == 1 ? version1header : sizeof(head);
+	if (data.size() < headsize) {
+		throw exceptionhandler(path + " is truncated (rostercheckpoint)");
+	}
+	memcpy(&head, data.data(), headsize);
+	const uint64_t recordsend = headsize + static_cast<uint64_t>(head.count) * sizeof(rostersnapshot::record);
+	const uint64_t stringsstart = recordsend + static_cast<uint64_t>(head.tombstones) * sizeof(uint32_t);
+	if (stringsstart > data.size() || head.stringssize > data.size() - stringsstart) {
+		throw exceptionhandler(path + " is truncated (rostercheckpoint)");
+	}
+	const char* strings = data.data() + stringsstart;
+
+	for (uint32_t r = 0; r < head.count; ++r) {
+		rostersnapshot::record rec;
+		memcpy(&rec, data.data() + headsize + r * sizeof(rec), sizeof(rec));
+		if (static_cast<uint64_t>(rec.nameoffset) + rec.namelength > head.stringssize
+			|| static_cast<uint64_t>(rec.contactoffset) + rec.contactlength > head.stringssize
+			|| rec.rank > StudentInfo::Black || rec.stripes > StudentInfo::four) {
+			throw exceptionhandler(path + " is corrupt (rostercheckpoint)");
+		}
+		const string name(strings + rec.nameoffset, rec.namelength);
+		const string contact(strings + rec.contactoffset, rec.contactlength);
+		unordered_map<uint32_t, StudentInfo*>::iterator found = byid.find(rec.id);
+		if (found != byid.end()) {
+			setfields(found->second, name, contact, rec);
+		}
+		else {
+			StudentInfo* cur = new dojostudent();
+			setfields(cur, name, contact, rec);
+			cur->setid(rec.id);
+			target += cur;
+			byid[rec.id] = cur;
+		}
+	}
+	for (uint32_t t = 0; t < head.tombstones; ++t) {
+		uint32_t id;
+		memcpy(&id, data.data() + recordsend + t * sizeof(uint32_t), sizeof(id));
+		unordered_map<uint32_t, StudentInfo*>::iterator found = byid.find(id);
+		if (found != byid.end()) {
+			removed.insert(found->second);
+			byid.erase(found);
+		}
+	}
+	target.reserveids(head.nextid); //0 for a version 1 delta
+}
+
+//runs on the compactor thread, only touches files
+void rostercheckpoint::compactfiles(const string& base, uint32_t upto)
+{
+	{
+		DojoManager merged;
+		restore(base, upto, merged);
+		//synced to disk and renamed into place, directory included, before
+		//any delta goes, so a power cut can't leave an empty base and no deltas
+		rostersnapshot::save(merged, base);
+	}
+	//oldest first: a crash part way leaves the newest deltas, which replay
+	//cleanly over the new base
+	error_code failed;
+	const vector<uint32_t> deltas = deltasof(base);
+	for (size_t d = 0; d < deltas.size() && deltas[d] <= upto; ++d) {
+		filesystem::remove(deltapath(base, deltas[d]), failed);
+	}
+	durablefile::syncdir(base);
+}
+
+//delta numbers found next to the base, oldest first
+vector<uint32_t> rostercheckpoint::deltasof(const string& base)
+{
+	vector<uint32_t> found;
+	const filesystem::path basefile(base);
+	filesystem::path dir = basefile.parent_path();
+	if (dir.empty()) {
+		dir = ".";
+	}
+	const string prefix = basefile.filename().string() + deltainfix;
+	error_code failed;
+	for (filesystem::directory_iterator it(dir, failed), end; !failed && it != end; it.increment(failed)) {
+		const string name = it->path().filename().string();
+		if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+			continue;
+		}
+		uint32_t seq = 0;
+		const char* first = name.data() + prefix.size();
+		const char* last = name.data() + name.size();
+		const from_chars_result parsed = from_chars(first, last, seq);
+		if (parsed.ec == errc() && parsed.ptr == last) {
+			found.push_back(seq); //skips the .tmp ones
+		}
+	}
+	std::sort(found.begin(), found.end());
+	return found;
+}
+
+string rostercheckpoint::deltapath(const string& base, uint32_t seq)
+{
+	return base + deltainfix + to_string(seq);
+}
+
+void rostercheckpoint::added(int, const StudentInfo* s)
+{
+	dirty.insert(s);
+}
+
+void rostercheckpoint::removing(int, const StudentInfo* s)
+{
+	tombstones.push_back(s->getid());
+	dirty.erase(s);
+}
+
+void rostercheckpoint::changed(int, const StudentInfo* s)
+{
+	dirty.insert(s);
+}
+
+void rostercheckpoint::sorted(const studentorder&)
+{
+}
+
+void rostercheckpoint::cleared()
+{
+	for (int i = 0; i < roster->getsize(); ++i) {
+		tombstones.push_back(roster->getind(i)->getid());
+	}
+	dirty.clear();
+}
+
+void rostercheckpoint::detached()
+{
+	//the dirty students went with the roster, checkpoint() now throws
+	roster = nullptr;
+	dirty.clear();
+}
@@ -0,0 +1,81 @@
+//incremental persistence for a big roster: one full snapshot (the base)
+//plus small delta files holding only the students changed since the last
+//checkpoint and tombstones for the ones removed. students are matched up
+//across files by StudentInfo::getid(). deltas are folded back into the
+//base on a worker thread by startcompaction(). ex:
+//	rostercheckpoint cp; cp.open("roster.snap", roster);
+//	... nightly: cp.checkpoint(); cp.startcompaction();
+//a restored roster holds the base's order followed by later additions,
+//sorting isn't recorded
+#pragma once
+#include "DojoManager.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+using namespace std;
+
+class rostercheckpoint : private rosterlistener
+{
+public:
+	rostercheckpoint();
+	~rostercheckpoint();
+
+	//loads the base and every delta into an empty roster, then tracks it
+	void open(const string&, DojoManager&);
+	void close();
+
+	//writes the next delta, returns the number of students and tombstones in it
+	int checkpoint();
+	int dirtycount() const;
+
+	//rewrites the base with every delta written so far, then deletes them.
+	//throws exceptionhandler first if the previous run failed unreported
+	void startcompaction();
+	//waits for the compaction, throws exceptionhandler if it failed
+	void waitcompaction();
+	bool compacting() const;
+
+private:
+	struct deltaheader {
+		char magic[8]; //"DOJODELT"
+		uint32_t version; //1 = no nextid, still read
+		uint32_t recordsize;
+		uint32_t count;
+		uint32_t tombstones;
+		uint64_t stringssize;
+		uint32_t nextid; //DojoManager::getnextid() at the checkpoint
+		uint32_t reserved;
+	};
+
+	DojoManager* roster;
+	string basepath;
+	uint32_t nextdelta;
+	unordered_set<const StudentInfo*> dirty;
+	vector<uint32_t> tombstones;
+
+	thread compactor;
+	atomic<bool> busy;
+	string compacterror;
+
+	//base + deltas up to the given number into an empty roster
+	static void restore(const string&, uint32_t, DojoManager&);
+	static void applydelta(const string&, DojoManager&, unordered_map<uint32_t, StudentInfo*>&,
+		unordered_set<StudentInfo*>&);
+	static void compactfiles(const string&, uint32_t);
+	static vector<uint32_t> deltasof(const string&);
+	static string deltapath(const string&, uint32_t);
+
+	virtual void added(int, const StudentInfo*) override;
+	virtual void removing(int, const StudentInfo*) override;
+	virtual void changed(int, const StudentInfo*) override;
+	virtual void sorted(const studentorder&) override;
+	virtual void cleared() override;
+	virtual void detached() override;
+
+	rostercheckpoint(const rostercheckpoint&);
+	rostercheckpoint& operator=(const rostercheckpoint&);
+};
@@ -0,0 +1,202 @@
+#include "rostercolumns.h"
+#include "DojoManager.h"
+#include "exceptionhandler.h"
+using namespace std;
+
+rostercolumns::rostercolumns() : agecol(), monthcol(), rankcol(), stripecol(),
+gearcol(), returncol(), namecol(), contactcol(), stringpool()
+{
+}
+
+void rostercolumns::build(const DojoManager& roster)
+{
+	clear();
+	const int n = roster.getsize();
+	agecol.reserve(n);
+	monthcol.reserve(n);
+	rankcol.reserve(n);
+	stripecol.reserve(n);
+	gearcol.reserve(n);
+	returncol.reserve(n);
+	namecol.reserve(n);
+	contactcol.reserve(n);
+
+	for (int i = 0; i < n; ++i) {
+		StudentInfo* cur = roster.getind(i);
+		if (cur) {
+			append(*cur);
+		}
+		else {
+			appendblank();
+		}
+	}
+}
+
+void rostercolumns::clear()
+{
+	agecol.clear();
+	monthcol.clear();
+	rankcol.clear();
+	stripecol.clear();
+	gearcol.clear();
+	returncol.clear();
+	namecol.clear();
+	contactcol.clear();
+	stringpool.clear();
+}
+
+int rostercolumns::size() const
+{
+	return static_cast<int>(agecol.size());
+}
+
+void rostercolumns::append(const StudentInfo& s)
+{
+	agecol.push_back(s.getAge());
+	monthcol.push_back(s.getMonths());
+	rankcol.push_back(static_cast<uint8_t>(s.getRank()));
+	stripecol.push_back(static_cast<uint8_t>(s.getStripes()));
+	gearcol.push_back(s.getGear() ? 1 : 0);
+	returncol.push_back(s.getReturning() ? 1 : 0);
+	namecol.push_back(store(s.getName()));
+	contactcol.push_back(store(s.getContact()));
+}
+
+//keeps rows lined up with roster indexes when a slot holds no student
+void rostercolumns::appendblank()
+{
+	const StudentInfo::StudentInf blank;
+	agecol.push_back(blank.age);
+	monthcol.push_back(blank.monthsEnrolled);
+	rankcol.push_back(static_cast<uint8_t>(blank.rank));
+	stripecol.push_back(static_cast<uint8_t>(blank.stripes));
+	gearcol.push_back(blank.needsGear ? 1 : 0);
+	returncol.push_back(blank.isReturning ? 1 : 0);
+	namecol.push_back(store(blank.name));
+	contactcol.push_back(store(blank.Contact));
+}
+
+void rostercolumns::sync(int row, const StudentInfo& s)
+{
+	checkrow(row, "rostercolumns::sync");
+	agecol[row] = s.getAge();
+	monthcol[row] = s.getMonths();
+	rankcol[row] = static_cast<uint8_t>(s.getRank());
+	stripecol[row] = static_cast<uint8_t>(s.getStripes());
+	gearcol[row] = s.getGear() ? 1 : 0;
+	returncol[row] = s.getReturning() ? 1 : 0;
+	//strings only get re-stored when they changed, the old text stays in the
+	//pool until compact()
+	if (stringpool.compare(namecol[row].offset, namecol[row].length, s.getName()) != 0) {
+		namecol[row] = store(s.getName());
+	}
+	if (stringpool.compare(contactcol[row].offset, contactcol[row].length, s.getContact()) != 0) {
+		contactcol[row] = store(s.getContact());
+	}
+}
+
+void rostercolumns::copyto(int row, StudentInfo& s) const
+{
+	checkrow(row, "rostercolumns::copyto");
+	s.setName(fetch(namecol[row]));
+	s.setAge(agecol[row]);
+	s.setMonths(monthcol[row]);
+	s.setRank(static_cast<StudentInfo::BeltRank>(rankcol[row]));
+	s.setStripes(static_cast<StudentInfo::BeltStripes>(stripecol[row]));
+	s.setGear(gearcol[row] != 0);
+	s.setReturning(returncol[row] != 0);
+	s.setContact(fetch(contactcol[row]));
+}
+
+void rostercolumns::compact()
+{
+	string packed;
+	packed.reserve(stringpool.size());
+	for (size_t i = 0; i < namecol.size(); ++i) {
+		const textref name = namecol[i];
+		namecol[i].offset = static_cast<uint32_t>(packed.size());
+		packed.append(stringpool, name.offset, name.length);
+
+		const textref contact = contactcol[i];
+		contactcol[i].offset = static_cast<uint32_t>(packed.size());
+		packed.append(stringpool, contact.offset, contact.length);
+	}
+	stringpool.swap(packed);
+}
+
+vector<int> rostercolumns::matching(StudentInfo::BeltRank rank, int minage, int maxage, bool needsgear) const
+{
+	vector<int> rows;
+	const int n = size();
+	const uint8_t wantrank = static_cast<uint8_t>(rank);
+	const uint8_t wantgear = needsgear ? 1 : 0;
+	for (int i = 0; i < n; ++i) {
+		if (rankcol[i] == wantrank && gearcol[i] == wantgear && agecol[i] >= minage && agecol[i] <= maxage) {
+			rows.push_back(i);
+		}
+	}
+	return rows;
+}
+
+string rostercolumns::name(int row) const
+{
+	checkrow(row, "rostercolumns::name");
+	return fetch(namecol[row]);
+}
+
+string rostercolumns::contact(int row) const
+{
+	checkrow(row, "rostercolumns::contact");
+	return fetch(contactcol[row]);
+}
+
+const int32_t* rostercolumns::ages() const
+{
+	return agecol.data();
+}
+
+const int32_t* rostercolumns::months() const
+{
+	return monthcol.data();
+}
+
+const uint8_t* rostercolumns::ranks() const
+{
+	return rankcol.data();
+}
+
+const uint8_t* rostercolumns::stripes() const
+{
+	return stripecol.data();
+}
+
+const uint8_t* rostercolumns::needsgear() const
+{
+	return gearcol.data();
+}
+
+const uint8_t* rostercolumns::returning() const
+{
+	return returncol.data();
+}
+
+rostercolumns::textref rostercolumns::store(const string& text)
+{
+	textref ref;
+	ref.offset = static_cast<uint32_t>(stringpool.size());
+	ref.length = static_cast<uint32_t>(text.size());
+	stringpool.append(text);
+	return ref;
+}
+
+string rostercolumns::fetch(const textref& ref) const
+{
+	return stringpool.substr(ref.offset, ref.length);
+}
+
+void rostercolumns::checkrow(int row, const char* where) const
+{
+	if (row < 0 || row >= size()) {
+		throw exceptionhandler(string("Index out of bounds (") + where + ")");
+	}
+}
@@ -0,0 +1,64 @@
+//column per field copy of the roster for report scans, hot fields packed
+//tight and the names/contacts kept out of the way in one string pool
+#pragma once
+#include "StudentInfo.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+using namespace std;
+class DojoManager;
+
+class rostercolumns
+{
+public:
+	rostercolumns();
+
+	void build(const DojoManager&);
+	void clear();
+
+	int size() const;
+
+	void append(const StudentInfo&);
+	//refresh row from the student after it was edited
+	void sync(int, const StudentInfo&);
+	//push the row back into a student
+	void copyto(int, StudentInfo&) const;
+	//squeeze out strings left behind by sync
+	void compact();
+
+	//rows with that rank, minage <= age <= maxage and the gear flag
+	vector<int> matching(StudentInfo::BeltRank, int, int, bool) const;
+
+	string name(int) const;
+	string contact(int) const;
+
+	//raw columns for the scan kernels
+	const int32_t* ages() const;
+	const int32_t* months() const;
+	const uint8_t* ranks() const;
+	const uint8_t* stripes() const;
+	const uint8_t* needsgear() const;
+	const uint8_t* returning() const;
+
+private:
+	vector<int32_t> agecol;
+	vector<int32_t> monthcol;
+	vector<uint8_t> rankcol;
+	vector<uint8_t> stripecol;
+	vector<uint8_t> gearcol;
+	vector<uint8_t> returncol;
+
+	//cold strings: offset and length of each row's text in stringpool
+	struct textref {
+		uint32_t offset;
+		uint32_t length;
+	};
+	vector<textref> namecol;
+	vector<textref> contactcol;
+	string stringpool;
+
+	void appendblank();
+	textref store(const string&);
+	string fetch(const textref&) const;
+	void checkrow(int, const char*) const;
+};
@@ -0,0 +1,291 @@
+#include "rosterfilter.h"
+using namespace std;
+
+#if defined(__AVX2__)
+#define ROSTER_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ROSTER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+int rosterfilter::popcount(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(word));
+#elif defined(__GNUC__)
+	return __builtin_popcountll(word);
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+//the word kernels each look at exactly 64 values and return one bit per value.
+//every one the build can run is compiled, the best is picked once
+namespace {
+	uint64_t rangescalar(const int32_t* p, int32_t lo, int32_t hi)
+	{
+		uint64_t word = 0;
+		for (int i = 0; i < 64; ++i) {
+			word |= static_cast<uint64_t>(p[i] >= lo && p[i] <= hi) << i;
+		}
+		return word;
+	}
+
+	uint64_t equalscalar(const uint8_t* p, uint8_t wanted)
+	{
+		uint64_t word = 0;
+		for (int i = 0; i < 64; ++i) {
+			word |= static_cast<uint64_t>(p[i] == wanted) << i;
+		}
+		return word;
+	}
+
+#if defined(ROSTER_SSE2)
+	uint64_t rangesse2(const int32_t* p, int32_t lo, int32_t hi)
+	{
+		uint64_t word = 0;
+		const __m128i vlo = _mm_set1_epi32(lo);
+		const __m128i vhi = _mm_set1_epi32(hi);
+		for (int i = 0; i < 64; i += 4) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			const __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(vlo, v), _mm_cmpgt_epi32(v, vhi));
+			const unsigned bits = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(outside)));
+			word |= static_cast<uint64_t>(~bits & 0xFu) << i;
+		}
+		return word;
+	}
+
+	uint64_t equalsse2(const uint8_t* p, uint8_t wanted)
+	{
+		uint64_t word = 0;
+		const __m128i vwant = _mm_set1_epi8(static_cast<char>(wanted));
+		for (int i = 0; i < 64; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			const unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, vwant)));
+			word |= static_cast<uint64_t>(bits) << i;
+		}
+		return word;
+	}
+#endif
+
+#if defined(ROSTER_AVX2)
+	uint64_t rangeavx2(const int32_t* p, int32_t lo, int32_t hi)
+	{
+		uint64_t word = 0;
+		const __m256i vlo = _mm256_set1_epi32(lo);
+		const __m256i vhi = _mm256_set1_epi32(hi);
+		for (int i = 0; i < 64; i += 8) {
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+			//outside = lo > v or v > hi
+			const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, v), _mm256_cmpgt_epi32(v, vhi));
+			const unsigned bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(outside)));
+			word |= static_cast<uint64_t>(~bits & 0xFFu) << i;
+		}
+		return word;
+	}
+
+	uint64_t equalavx2(const uint8_t* p, uint8_t wanted)
+	{
+		uint64_t word = 0;
+		const __m256i vwant = _mm256_set1_epi8(static_cast<char>(wanted));
+		for (int i = 0; i < 64; i += 32) {
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+			const unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vwant)));
+			word |= static_cast<uint64_t>(bits) << i;
+		}
+		return word;
+	}
+#endif
+}
+
+#if defined(ROSTER_AVX2)
+rosterfilter::kernel rosterfilter::active = rosterfilter::avx2kernel;
+#elif defined(ROSTER_SSE2)
+rosterfilter::kernel rosterfilter::active = rosterfilter::sse2kernel;
+#else
+rosterfilter::kernel rosterfilter::active = rosterfilter::scalarkernel;
+#endif
+
+bool rosterfilter::haskernel(kernel k)
+{
+	switch (k) {
+	case scalarkernel:
+		return true;
+#if defined(ROSTER_SSE2)
+	case sse2kernel:
+		return true;
+#endif
+#if defined(ROSTER_AVX2)
+	case avx2kernel:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+rosterfilter::kernel rosterfilter::usekernel(kernel k)
+{
+	const kernel before = active;
+	if (haskernel(k)) {
+		active = k;
+	}
+	return before;
+}
+
+uint64_t rosterfilter::rangeword(const int32_t* p, int32_t lo, int32_t hi)
+{
+	switch (active) {
+#if defined(ROSTER_AVX2)
+	case avx2kernel:
+		return rangeavx2(p, lo, hi);
+#endif
+#if defined(ROSTER_SSE2)
+	case sse2kernel:
+		return rangesse2(p, lo, hi);
+#endif
+	default:
+		return rangescalar(p, lo, hi);
+	}
+}
+
+uint64_t rosterfilter::equalword(const uint8_t* p, uint8_t wanted)
+{
+	switch (active) {
+#if defined(ROSTER_AVX2)
+	case avx2kernel:
+		return equalavx2(p, wanted);
+#endif
+#if defined(ROSTER_SSE2)
+	case sse2kernel:
+		return equalsse2(p, wanted);
+#endif
+	default:
+		return equalscalar(p, wanted);
+	}
+}
+
+rosterfilter::bitmap rosterfilter::inrange(const int32_t* values, int n, int32_t lo, int32_t hi)
+{
+	bitmap result((n + 63) / 64, 0);
+	const int full = n / 64;
+	for (int w = 0; w < full; ++w) {
+		result[w] = rangeword(values + w * 64, lo, hi);
+	}
+	for (int i = full * 64; i < n; ++i) {
+		result[i / 64] |= static_cast<uint64_t>(values[i] >= lo && values[i] <= hi) << (i % 64);
+	}
+	return result;
+}
+
+rosterfilter::bitmap rosterfilter::equals(const uint8_t* values, int n, uint8_t wanted)
+{
+	bitmap result((n + 63) / 64, 0);
+	const int full = n / 64;
+	for (int w = 0; w < full; ++w) {
+		result[w] = equalword(values + w * 64, wanted);
+	}
+	for (int i = full * 64; i < n; ++i) {
+		result[i / 64] |= static_cast<uint64_t>(values[i] == wanted) << (i % 64);
+	}
+	return result;
+}
+
+rosterfilter::bitmap rosterfilter::istrue(const uint8_t* values, int n)
+{
+	//true is anything but 0, so flip the "equals 0" bits
+	bitmap result = equals(values, n, 0);
+	for (size_t w = 0; w < result.size(); ++w) {
+		result[w] = ~result[w];
+	}
+	if (n % 64 != 0) {
+		result.back() &= (1ULL << (n % 64)) - 1;
+	}
+	return result;
+}
+
+int rosterfilter::countinrange(const int32_t* values, int n, int32_t lo, int32_t hi)
+{
+	int total = 0;
+	const int full = n / 64;
+	for (int w = 0; w < full; ++w) {
+		total += popcount(rangeword(values + w * 64, lo, hi));
+	}
+	for (int i = full * 64; i < n; ++i) {
+		total += (values[i] >= lo && values[i] <= hi);
+	}
+	return total;
+}
+
+int rosterfilter::countequals(const uint8_t* values, int n, uint8_t wanted)
+{
+	int total = 0;
+	const int full = n / 64;
+	for (int w = 0; w < full; ++w) {
+		total += popcount(equalword(values + w * 64, wanted));
+	}
+	for (int i = full * 64; i < n; ++i) {
+		total += (values[i] == wanted);
+	}
+	return total;
+}
+
+int rosterfilter::counttrue(const uint8_t* values, int n)
+{
+	return n - countequals(values, n, 0);
+}
+
+void rosterfilter::andwith(bitmap& target, const bitmap& other)
+{
+	const size_t n = target.size() < other.size() ? target.size() : other.size();
+	for (size_t w = 0; w < n; ++w) {
+		target[w] &= other[w];
+	}
+	for (size_t w = n; w < target.size(); ++w) {
+		target[w] = 0;
+	}
+}
+
+void rosterfilter::orwith(bitmap& target, const bitmap& other)
+{
+	if (target.size() < other.size()) {
+		target.resize(other.size(), 0);
+	}
+	for (size_t w = 0; w < other.size(); ++w) {
+		target[w] |= other[w];
+	}
+}
+
+int rosterfilter::count(const bitmap& selection)
+{
+	int total = 0;
+	for (size_t w = 0; w < selection.size(); ++w) {
+		total += popcount(selection[w]);
+	}
+	return total;
+}
+
+vector<int> rosterfilter::rows(const bitmap& selection)
+{
+	vector<int> result;
+	result.reserve(count(selection));
+	for (size_t w = 0; w < selection.size(); ++w) {
+		uint64_t word = selection[w];
+		while (word) {
+			//bits below the lowest set bit give its position
+			const uint64_t low = word & (~word + 1);
+			result.push_back(static_cast<int>(w * 64) + popcount(low - 1));
+			word &= word - 1;
+		}
+	}
+	return result;
+}
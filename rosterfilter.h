@@ -0,0 +1,48 @@
+//predicate kernels over rostercolumns style packed arrays. results are
+//selection bitmaps (bit i of word i/64 = row i) or plain counts
+#pragma once
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+class rosterfilter
+{
+public:
+	typedef vector<uint64_t> bitmap;
+
+	//lo <= value <= hi, for ages and months enrolled
+	static bitmap inrange(const int32_t*, int, int32_t, int32_t);
+	//value == wanted, for ranks and stripes
+	static bitmap equals(const uint8_t*, int, uint8_t);
+	//value != 0, for needs gear and returning
+	static bitmap istrue(const uint8_t*, int);
+
+	static int countinrange(const int32_t*, int, int32_t, int32_t);
+	static int countequals(const uint8_t*, int, uint8_t);
+	static int counttrue(const uint8_t*, int);
+
+	static void andwith(bitmap&, const bitmap&);
+	static void orwith(bitmap&, const bitmap&);
+	static int count(const bitmap&);
+	static vector<int> rows(const bitmap&);
+
+	static int popcount(uint64_t);
+
+	//the word kernels this build was compiled with: scalar always, SSE2 on
+	//x64, AVX2 with /arch:AVX2 or -mavx2. the best one runs unless a test
+	//pins another; usekernel returns the one it replaced and ignores a
+	//kernel the build lacks. not for use while other threads filter
+	enum kernel {
+		scalarkernel,
+		sse2kernel,
+		avx2kernel
+	};
+	static bool haskernel(kernel);
+	static kernel usekernel(kernel);
+
+private:
+	static kernel active;
+
+	static uint64_t rangeword(const int32_t*, int32_t, int32_t);
+	static uint64_t equalword(const uint8_t*, uint8_t);
+};
@@ -0,0 +1,165 @@
+#include "rostergroups.h"
+#include "DojoManager.h"
+#include "rosterview.h"
+#include "FinancialSystem.h"
+using namespace std;
+
+rostergroups::groupstats::groupstats() : count(0), valuesum(0.0), monthsum(0)
+{
+}
+
+double rostergroups::groupstats::avgmonths() const
+{
+	if (count == 0) {
+		return 0.0;
+	}
+	return static_cast<double>(monthsum) / count;
+}
+
+void rostergroups::groupstats::add(const groupstats& other)
+{
+	count += other.count;
+	valuesum += other.valuesum;
+	monthsum += other.monthsum;
+}
+
+int rostergroups::keycount(groupkey key)
+{
+	switch (key) {
+	case byrank:
+		return StudentInfo::Black + 1;
+	case bystripes:
+		return StudentInfo::four + 1;
+	case byagebracket:
+	default:
+		return FinancialSystem::adult + 1;
+	}
+}
+
+int rostergroups::keyfrom(int rank, int stripes, int age, groupkey key)
+{
+	switch (key) {
+	case byrank:
+		return rank;
+	case bystripes:
+		return stripes;
+	case byagebracket:
+	default:
+		return FinancialSystem::bracketof(age);
+	}
+}
+
+int rostergroups::keyof(const StudentInfo& s, groupkey key)
+{
+	return keyfrom(s.getRank(), s.getStripes(), s.getAge(), key);
+}
+
+int rostergroups::keyof(const rosterview& view, int index, groupkey key)
+{
+	return keyfrom(view.rank(index), view.stripes(index), view.age(index), key);
+}
+
+int rostergroups::keypart(uint32_t packed, int position)
+{
+	return static_cast<int>((packed >> (8 * position)) & 0xFF);
+}
+
+namespace {
+	//adapters so both roster kinds feed the same grouping loops
+	struct managerrows {
+		const DojoManager& roster;
+		bool row(int i, int& rank, int& stripes, int& age, double& value, int& months) const {
+			const StudentInfo* cur = roster.getind(i);
+			if (!cur) {
+				return false;
+			}
+			rank = cur->getRank();
+			stripes = cur->getStripes();
+			age = cur->getAge();
+			value = cur->getvalue();
+			months = cur->getMonths();
+			return true;
+		}
+	};
+
+	struct viewrows {
+		const rosterview& view;
+		bool row(int i, int& rank, int& stripes, int& age, double& value, int& months) const {
+			rank = view.rank(i);
+			stripes = view.stripes(i);
+			age = view.age(i);
+			value = view.getvalue(i);
+			months = view.months(i);
+			return true;
+		}
+	};
+}
+
+template <typename Source>
+vector<rostergroups::groupstats> rostergroups::densegroups(const Source& source, int n, groupkey key)
+{
+	const int limit = keycount(key);
+	vector<groupstats> groups(limit);
+	int rank, stripes, age, months;
+	double value;
+	for (int i = 0; i < n; ++i) {
+		if (!source.row(i, rank, stripes, age, value, months)) {
+			continue;
+		}
+		const int slot = keyfrom(rank, stripes, age, key);
+		if (slot < 0 || slot >= limit) {
+			continue; //enum holds a value outside the named ones
+		}
+		groupstats& g = groups[slot];
+		++g.count;
+		g.valuesum += value;
+		g.monthsum += months;
+	}
+	return groups;
+}
+
+template <typename Source>
+rostergroups::compositegroups rostergroups::hashedgroups(const Source& source, int n, const vector<groupkey>& keys)
+{
+	compositegroups groups;
+	int rank, stripes, age, months;
+	double value;
+	for (int i = 0; i < n; ++i) {
+		if (!source.row(i, rank, stripes, age, value, months)) {
+			continue;
+		}
+		uint32_t packed = 0;
+		for (size_t k = 0; k < keys.size() && k < 4; ++k) {
+			packed |= static_cast<uint32_t>(keyfrom(rank, stripes, age, keys[k]) & 0xFF) << (8 * k);
+		}
+		groupstats& g = groups[packed];
+		++g.count;
+		g.valuesum += value;
+		g.monthsum += months;
+	}
+	return groups;
+}
+
+vector<rostergroups::groupstats> rostergroups::groupby(const DojoManager& roster, groupkey key)
+{
+	managerrows rows = { roster };
+	return densegroups(rows, roster.getsize(), key);
+}
+
+rostergroups::compositegroups rostergroups::groupby(const DojoManager& roster, const vector<groupkey>& keys)
+{
+	managerrows rows = { roster };
+	return hashedgroups(rows, roster.getsize(), keys);
+}
+
+vector<rostergroups::groupstats> rostergroups::groupby(const rosterview& view, groupkey key)
+{
+	viewrows rows = { view };
+	return densegroups(rows, view.getsize(), key);
+}
+
+rostergroups::compositegroups rostergroups::groupby(const rosterview& view, const vector<groupkey>& keys)
+{
+	viewrows rows = { view };
+	return hashedgroups(rows, view.getsize(), keys);
+}
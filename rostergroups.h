@@ -0,0 +1,53 @@
+//group-by for the monthly reports: counts, value totals and months
+//enrolled per belt rank, stripe count or pricing age bracket
+#pragma once
+#include "StudentInfo.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+using namespace std;
+class DojoManager;
+class rosterview;
+
+class rostergroups
+{
+public:
+	enum groupkey {
+		byrank,
+		bystripes,
+		byagebracket //FinancialSystem::agebracket
+	};
+
+	struct groupstats {
+		int count;
+		double valuesum; //getvalue() total
+		long long monthsum;
+
+		groupstats();
+		double avgmonths() const;
+		void add(const groupstats&);
+	};
+
+	//composite keys pack one byte per key, first key in the low byte
+	typedef unordered_map<uint32_t, groupstats> compositegroups;
+
+	//one slot per enum value, index with the enum
+	static vector<groupstats> groupby(const DojoManager&, groupkey);
+	static compositegroups groupby(const DojoManager&, const vector<groupkey>&);
+	//same groups over a mapped snapshot
+	static vector<groupstats> groupby(const rosterview&, groupkey);
+	static compositegroups groupby(const rosterview&, const vector<groupkey>&);
+
+	static int keycount(groupkey);
+	static int keyof(const StudentInfo&, groupkey);
+	static int keyof(const rosterview&, int, groupkey);
+	static int keypart(uint32_t, int);
+
+private:
+	static int keyfrom(int, int, int, groupkey);
+	//rows are pulled through Source::row(i, rank, stripes, age, value, months)
+	template <typename Source>
+	static vector<groupstats> densegroups(const Source&, int, groupkey);
+	template <typename Source>
+	static compositegroups hashedgroups(const Source&, int, const vector<groupkey>&);
+};
@@ -0,0 +1,508 @@
+#include "rosterimport.h"
+#include "DojoManager.h"
+#include "dojostudent.h"
+#include "karatedojo.h"
+#include "exceptionhandler.h"
+#include "beltnames.h"
+#include <fstream>
+#include <charconv>
+#include <cctype>
+using namespace std;
+
+namespace {
+	const size_t chunksize = 1 << 20;
+	const size_t maxerrors = 50;
+	//csv column order, also every key setfield knows
+	const char* const columns[] = { "name", "age", "returning", "months", "rank", "stripes", "needsgear", "contact" };
+	const int columncount = 8;
+
+	bool isfield(string_view key) {
+		for (int c = 0; c < columncount; ++c) {
+			if (key == columns[c]) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	string_view trim(string_view text) {
+		while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+			text.remove_prefix(1);
+		}
+		while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+			text.remove_suffix(1);
+		}
+		return text;
+	}
+
+	bool sameword(string_view a, string_view b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); ++i) {
+			if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool parseint(string_view text, int& value) {
+		text = trim(text);
+		if (!text.empty() && text.front() == '+') {
+			text.remove_prefix(1);
+		}
+		from_chars_result r = from_chars(text.data(), text.data() + text.size(), value);
+		return r.ec == errc() && r.ptr == text.data() + text.size() && !text.empty();
+	}
+
+	bool parsebool(string_view text, bool& value) {
+		text = trim(text);
+		if (text == "1" || sameword(text, "true") || sameword(text, "y") || sameword(text, "yes")) {
+			value = true;
+			return true;
+		}
+		if (text == "0" || sameword(text, "false") || sameword(text, "n") || sameword(text, "no")) {
+			value = false;
+			return true;
+		}
+		return false;
+	}
+
+	//number or the name of the enum value
+	template <size_t N>
+	bool parseenum(string_view text, const enumtable<N>& names, int& value) {
+		text = trim(text);
+		if (parseint(text, value)) {
+			return value >= 0 && value < static_cast<int>(names.size());
+		}
+		value = names.parse(text);
+		return value >= 0;
+	}
+
+	//reads a JSON string starting after the opening quote, pos ends past the closing one
+	bool readjsonstring(string_view line, size_t& pos, string& out) {
+		out.clear();
+		while (pos < line.size()) {
+			const char c = line[pos++];
+			if (c == '"') {
+				return true;
+			}
+			if (c != '\\') {
+				out += c;
+				continue;
+			}
+			if (pos >= line.size()) {
+				return false;
+			}
+			const char e = line[pos++];
+			switch (e) {
+			case 'n': out += '\n'; break;
+			case 't': out += '\t'; break;
+			case 'r': out += '\r'; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'u': {
+				if (pos + 4 > line.size()) {
+					return false;
+				}
+				unsigned code = 0;
+				from_chars_result r = from_chars(line.data() + pos, line.data() + pos + 4, code, 16);
+				if (r.ec != errc() || r.ptr != line.data() + pos + 4) {
+					return false;
+				}
+				pos += 4;
+				//basic plane only, written out as UTF-8
+				if (code < 0x80) {
+					out += static_cast<char>(code);
+				}
+				else if (code < 0x800) {
+					out += static_cast<char>(0xC0 | (code >> 6));
+					out += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else {
+					out += static_cast<char>(0xE0 | (code >> 12));
+					out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					out += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				break;
+			}
+			default: out += e; break; //covers \" \\ and \/
+			}
+		}
+		return false;
+	}
+
+	void skipspace(string_view line, size_t& pos) {
+		while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) {
+			++pos;
+		}
+	}
+
+	//steps over a nested object or array starting at pos, brackets have to
+	//pair up and strings inside may hold any of them. pos ends past the close
+	bool skipjsoncontainer(string_view line, size_t& pos) {
+		string closers;
+		string scratch;
+		while (pos < line.size()) {
+			const char c = line[pos++];
+			if (c == '"') {
+				if (!readjsonstring(line, pos, scratch)) {
+					return false;
+				}
+			}
+			else if (c == '{') {
+				closers += '}';
+			}
+			else if (c == '[') {
+				closers += ']';
+			}
+			else if (c == '}' || c == ']') {
+				if (closers.empty() || closers.back() != c) {
+					return false;
+				}
+				closers.pop_back();
+				if (closers.empty()) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+}
+
+rosterimport::result::result() : imported(0), rejected(0), errors()
+{
+}
+
+rosterimport::rosterimport(format f) : requested(f), mode(f), validator()
+{
+}
+
+rosterimport::result rosterimport::importfile(const string& path, DojoManager& roster)
+{
+	return run(path, [&roster](const StudentInfo::StudentInf& s, string&) {
+		roster += new dojostudent(s.name, s.age, s.isReturning, s.monthsEnrolled,
+			s.rank, s.stripes, s.needsGear, s.Contact);
+		return true;
+	});
+}
+
+rosterimport::result rosterimport::importfile(const string& path, karatedojo& dojo)
+{
+	return run(path, [&dojo](const StudentInfo::StudentInf& s, string& error) {
+		if (dojo.getregistrationsize() >= 100) {
+			error = "registration is full";
+			return false;
+		}
+		dojo.additemtodirect(s);
+		return true;
+	});
+}
+
+template <typename Sink>
+rosterimport::result rosterimport::run(const string& path, Sink sink)
+{
+	ifstream in(path.c_str(), ios::binary);
+	if (!in) {
+		throw exceptionhandler("could not open " + path + " (rosterimport::importfile)");
+	}
+
+	mode = requested;
+	result res;
+	vector<char> buffer(chunksize);
+	size_t filled = 0;
+	int lineno = 0;
+	bool seenfirst = false;
+	StudentInfo::StudentInf record;
+	string error;
+
+	//lines are handled straight out of the read buffer, only a line cut off
+	//by the end of a chunk gets moved to the front before the next read
+	bool more = true;
+	while (more) {
+		in.read(buffer.data() + filled, static_cast<streamsize>(buffer.size() - filled));
+		const size_t got = static_cast<size_t>(in.gcount());
+		filled += got;
+		more = got > 0;
+
+		size_t start = 0;
+		for (;;) {
+			size_t end = start;
+			while (end < filled && buffer[end] != '\n') {
+				++end;
+			}
+			if (end == filled && more) {
+				break; //partial line, wait for the next chunk
+			}
+			if (start == filled) {
+				break;
+			}
+
+			++lineno;
+			string_view line = trim(string_view(buffer.data() + start, end - start));
+			start = (end < filled) ? end + 1 : end;
+			if (line.empty()) {
+				continue;
+			}
+
+			if (!seenfirst) {
+				seenfirst = true;
+				if (mode == detect) {
+					mode = (line.front() == '{') ? ndjson : csv;
+				}
+				//csv exports usually start with a header row
+				if (mode == csv) {
+					const size_t comma = line.find(',');
+					if (sameword(trim(line.substr(0, comma)), "name")) {
+						continue;
+					}
+				}
+			}
+
+			error.clear();
+			if (parseline(line, record, error) && sink(record, error)) {
+				++res.imported;
+			}
+			else {
+				++res.rejected;
+				if (res.errors.size() < maxerrors) {
+					res.errors.push_back("line " + to_string(lineno) + ": " + error);
+				}
+			}
+		}
+
+		//keep the unfinished line, grow if one line fills the whole buffer
+		const size_t left = filled - start;
+		if (start > 0 && left > 0) {
+			copy(buffer.begin() + start, buffer.begin() + filled, buffer.begin());
+		}
+		filled = left;
+		if (filled == buffer.size()) {
+			buffer.resize(buffer.size() * 2);
+		}
+	}
+	return res;
+}
+
+bool rosterimport::parseline(string_view line, StudentInfo::StudentInf& s, string& error)
+{
+	s = StudentInfo::StudentInf();
+	format use = mode;
+	if (use == detect) {
+		use = (!line.empty() && line.front() == '{') ? ndjson : csv;
+	}
+	const bool ok = (use == ndjson) ? parsejson(line, s, error) : parsecsv(line, s, error);
+	return ok && checkrecord(s, error);
+}
+
+bool rosterimport::parsecsv(string_view line, StudentInfo::StudentInf& s, string& error)
+{
+	size_t pos = 0;
+	string unquoted;
+	for (int col = 0; col < columncount; ++col) {
+		if (pos > line.size()) {
+			error = "expected 8 columns, got " + to_string(col);
+			return false;
+		}
+		string_view field;
+		size_t lead = pos;
+		while (lead < line.size() && line[lead] == ' ') {
+			++lead;
+		}
+		if (lead < line.size() && line[lead] == '"') {
+			//quoted field, "" inside stands for one quote
+			unquoted.clear();
+			size_t i = lead + 1;
+			bool closed = false;
+			while (i < line.size()) {
+				if (line[i] == '"') {
+					if (i + 1 < line.size() && line[i + 1] == '"') {
+						unquoted += '"';
+						i += 2;
+						continue;
+					}
+					closed = true;
+					++i;
+					break;
+				}
+				unquoted += line[i++];
+			}
+			if (!closed) {
+				error = "unclosed quote in " + string(columns[col]);
+				return false;
+			}
+			while (i < line.size() && line[i] != ',') {
+				++i;
+			}
+			field = unquoted;
+			pos = i + 1;
+		}
+		else {
+			size_t comma = line.find(',', pos);
+			if (comma == string_view::npos) {
+				comma = line.size();
+			}
+			field = line.substr(pos, comma - pos);
+			pos = comma + 1;
+		}
+		if (!setfield(columns[col], field, s, error)) {
+			return false;
+		}
+	}
+	if (pos <= line.size()) {
+		error = "more than 8 columns";
+		return false;
+	}
+	return true;
+}
+
+bool rosterimport::parsejson(string_view line, StudentInfo::StudentInf& s, string& error)
+{
+	size_t pos = 0;
+	skipspace(line, pos);
+	if (pos >= line.size() || line[pos] != '{') {
+		error = "expected a JSON object";
+		return false;
+	}
+	++pos;
+
+	string key;
+	string text;
+	bool sawname = false;
+	for (;;) {
+		skipspace(line, pos);
+		if (pos < line.size() && line[pos] == '}') {
+			break;
+		}
+		if (pos >= line.size() || line[pos] != '"' || !readjsonstring(line, ++pos, key)) {
+			error = "bad JSON key";
+			return false;
+		}
+		skipspace(line, pos);
+		if (pos >= line.size() || line[pos] != ':') {
+			error = "expected ':' after " + key;
+			return false;
+		}
+		++pos;
+		skipspace(line, pos);
+
+		string_view value;
+		bool nested = false;
+		if (pos < line.size() && (line[pos] == '{' || line[pos] == '[')) {
+			//only unknown keys may hold a nested value, and it's skipped whole
+			if (isfield(key)) {
+				error = "expected a plain value for " + key;
+				return false;
+			}
+			if (!skipjsoncontainer(line, pos)) {
+				error = "unbalanced JSON value for " + key;
+				return false;
+			}
+			nested = true;
+		}
+		else if (pos < line.size() && line[pos] == '"') {
+			if (!readjsonstring(line, ++pos, text)) {
+				error = "bad JSON string for " + key;
+				return false;
+			}
+			value = text;
+		}
+		else {
+			const size_t begin = pos;
+			while (pos < line.size() && line[pos] != ',' && line[pos] != '}') {
+				++pos;
+			}
+			value = trim(line.substr(begin, pos - begin));
+		}
+
+		if (!nested && value != "null") {
+			if (!setfield(key, value, s, error)) {
+				return false;
+			}
+			sawname = sawname || key == "name";
+		}
+
+		skipspace(line, pos);
+		if (pos < line.size() && line[pos] == ',') {
+			++pos;
+			continue;
+		}
+		if (pos < line.size() && line[pos] == '}') {
+			break;
+		}
+		error = "expected ',' or '}' after " + key;
+		return false;
+	}
+	//one object per line, nothing may follow it
+	++pos;
+	skipspace(line, pos);
+	if (pos < line.size()) {
+		error = "unexpected text after the closing '}'";
+		return false;
+	}
+	if (!sawname) {
+		error = "missing name";
+		return false;
+	}
+	return true;
+}
+
+bool rosterimport::setfield(string_view key, string_view value, StudentInfo::StudentInf& s, string& error)
+{
+	bool ok = true;
+	int number = 0;
+	if (key == "name") {
+		s.name = string(trim(value));
+	}
+	else if (key == "contact") {
+		s.Contact = string(trim(value));
+	}
+	else if (key == "age") {
+		ok = parseint(value, s.age);
+	}
+	else if (key == "months") {
+		ok = parseint(value, s.monthsEnrolled);
+	}
+	else if (key == "returning") {
+		ok = parsebool(value, s.isReturning);
+	}
+	else if (key == "needsgear") {
+		ok = parsebool(value, s.needsGear);
+	}
+	else if (key == "rank") {
+		ok = parseenum(value, beltnames::ranks, number);
+		s.rank = static_cast<StudentInfo::BeltRank>(number);
+	}
+	else if (key == "stripes") {
+		ok = parseenum(value, beltnames::stripes, number);
+		s.stripes = static_cast<StudentInfo::BeltStripes>(number);
+	}
+	//unknown keys are ignored so newer exports still load
+	if (!ok) {
+		error = "bad value for " + string(key) + ": " + string(value);
+	}
+	return ok;
+}
+
+bool rosterimport::checkrecord(const StudentInfo::StudentInf& s, string& error)
+{
+	//same checks addStudent puts typed input through
+	if (!validator.validatestring(s.name)) {
+		error = "name is empty";
+		return false;
+	}
+	if (!validator.validateint(s.age) || s.age < 6 || s.age > 90) {
+		error = "age must be 6-90";
+		return false;
+	}
+	if (!validator.validateint(s.monthsEnrolled)) {
+		error = "months enrolled must be 0 or more";
+		return false;
+	}
+	if (!validator.validatestring(s.Contact)) {
+		error = "emergency contact is empty";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,49 @@
+//bulk roster import from CSV or NDJSON exports, read in big chunks and
+//checked with the same rules addStudent uses on typed input
+#pragma once
+#include "StudentInfo.h"
+#include "inputvalidator.h"
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+class DojoManager;
+class karatedojo;
+
+class rosterimport
+{
+public:
+	enum format {
+		detect, //by the first non blank character of the file
+		csv, //name,age,returning,months,rank,stripes,needsgear,contact
+		ndjson //one {"name":...,"age":...} object per line, same keys
+	};
+
+	struct result {
+		int imported;
+		int rejected;
+		vector<string> errors; //first few rejects, with line numbers
+		result();
+	};
+
+	rosterimport(format = detect);
+
+	result importfile(const string&, DojoManager&);
+	result importfile(const string&, karatedojo&);
+
+	//one line of the current format, false with a reason if it's no good
+	bool parseline(string_view, StudentInfo::StudentInf&, string&);
+
+private:
+	format requested;
+	format mode; //requested, or what detect settled on for this file
+	inputvalidator validator;
+
+	template <typename Sink>
+	result run(const string&, Sink);
+
+	bool parsecsv(string_view, StudentInfo::StudentInf&, string&);
+	bool parsejson(string_view, StudentInfo::StudentInf&, string&);
+	bool setfield(string_view, string_view, StudentInfo::StudentInf&, string&);
+	bool checkrecord(const StudentInfo::StudentInf&, string&);
+};
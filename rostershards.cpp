@@ -0,0 +1,204 @@
+#include "rostershards.h"
+#include "exceptionhandler.h"
+#include "namehash.h"
+#include <thread>
+#include <atomic>
+using namespace std;
+
+rostershards::rostershards(int count) : shards()
+{
+	if (count <= 0) {
+		throw exceptionhandler("Shard count must be positive (rostershards)");
+	}
+	shards.reserve(count);
+	for (int i = 0; i < count; ++i) {
+		shards.push_back(unique_ptr<DojoManager>(new DojoManager()));
+	}
+}
+
+int rostershards::shardcount() const
+{
+	return static_cast<int>(shards.size());
+}
+
+int rostershards::getsize() const
+{
+	int n = 0;
+	for (size_t i = 0; i < shards.size(); ++i) {
+		n += shards[i]->getsize();
+	}
+	return n;
+}
+
+DojoManager& rostershards::shard(int s)
+{
+	checkshard(s);
+	return *shards[s];
+}
+
+const DojoManager& rostershards::shard(int s) const
+{
+	checkshard(s);
+	return *shards[s];
+}
+
+int rostershards::add(StudentInfo* ptr, int location)
+{
+	if (location < 0) {
+		throw exceptionhandler("Location must not be negative (rostershards::add)");
+	}
+	const int s = location % shardcount();
+	assignid(ptr);
+	*shards[s] += ptr;
+	return s;
+}
+
+int rostershards::add(StudentInfo* ptr)
+{
+	const size_t h = ptr ? namehash()(ptr->getName()) : 0;
+	const int s = static_cast<int>(h % shards.size());
+	assignid(ptr);
+	*shards[s] += ptr;
+	return s;
+}
+
+//each shard only knows its own ids, so a new student takes the highest
+//next id of any shard; ids stay unique across the whole roster
+void rostershards::assignid(StudentInfo* ptr) const
+{
+	if (!ptr || ptr->getid() != 0) {
+		return;
+	}
+	unsigned int next = 1;
+	for (size_t i = 0; i < shards.size(); ++i) {
+		if (shards[i]->getnextid() > next) {
+			next = shards[i]->getnextid();
+		}
+	}
+	ptr->setid(next);
+}
+
+bool rostershards::remove(const position& at)
+{
+	checkshard(at.shard);
+	return shards[at.shard]->remove(at.index);
+}
+
+StudentInfo* rostershards::get(const position& at) const
+{
+	checkshard(at.shard);
+	return shards[at.shard]->getind(at.index);
+}
+
+rostershards::position rostershards::seqsearch(const string& name, int threads) const
+{
+	vector<int> found(shards.size(), -1);
+	fanout(threads, [this, &found, &name](int s) {
+		found[s] = shards[s]->seqsearch(name);
+	});
+	//lowest shard wins so the answer doesn't depend on thread timing
+	position result = { -1, -1 };
+	for (size_t s = 0; s < found.size(); ++s) {
+		if (found[s] >= 0) {
+			result.shard = static_cast<int>(s);
+			result.index = found[s];
+			break;
+		}
+	}
+	return result;
+}
+
+//every shard keeps its own running total, no need to go wide
+double rostershards::totalvalue() const
+{
+	double total = 0.0;
+	for (size_t s = 0; s < shards.size(); ++s) {
+		total += shards[s]->totalvalue();
+	}
+	return total;
+}
+
+double rostershards::recomputevalue(int threads) const
+{
+	vector<double> partial(shards.size(), 0.0);
+	fanout(threads, [this, &partial](int s) {
+		partial[s] = shards[s]->recomputevalue(1);
+	});
+	double total = 0.0;
+	for (size_t s = 0; s < partial.size(); ++s) {
+		total += partial[s];
+	}
+	return total;
+}
+
+vector<rostergroups::groupstats> rostershards::groupby(rostergroups::groupkey key, int threads) const
+{
+	vector<vector<rostergroups::groupstats>> partial(shards.size());
+	fanout(threads, [this, &partial, key](int s) {
+		partial[s] = rostergroups::groupby(*shards[s], key);
+	});
+	vector<rostergroups::groupstats> merged(rostergroups::keycount(key));
+	for (size_t s = 0; s < partial.size(); ++s) {
+		for (size_t g = 0; g < merged.size(); ++g) {
+			merged[g].add(partial[s][g]);
+		}
+	}
+	return merged;
+}
+
+rostergroups::compositegroups rostershards::groupby(const vector<rostergroups::groupkey>& keys, int threads) const
+{
+	vector<rostergroups::compositegroups> partial(shards.size());
+	fanout(threads, [this, &partial, &keys](int s) {
+		partial[s] = rostergroups::groupby(*shards[s], keys);
+	});
+	rostergroups::compositegroups merged;
+	for (size_t s = 0; s < partial.size(); ++s) {
+		for (rostergroups::compositegroups::const_iterator it = partial[s].begin(); it != partial[s].end(); ++it) {
+			merged[it->first].add(it->second);
+		}
+	}
+	return merged;
+}
+
+void rostershards::checkshard(int s) const
+{
+	if (s < 0 || s >= shardcount()) {
+		throw exceptionhandler("Shard out of bounds (rostershards)");
+	}
+}
+
+//workers pull shard numbers off a shared counter so one big location
+//doesn't hold up the rest of a worker's share
+template <typename Fn>
+void rostershards::fanout(int threads, Fn fn) const
+{
+	const int n = shardcount();
+	if (threads <= 0) {
+		threads = static_cast<int>(thread::hardware_concurrency());
+	}
+	if (threads > n) {
+		threads = n;
+	}
+	if (threads <= 1) {
+		for (int s = 0; s < n; ++s) {
+			fn(s);
+		}
+		return;
+	}
+
+	atomic<int> next(0);
+	auto work = [&next, &fn, n]() {
+		for (int s = next++; s < n; s = next++) {
+			fn(s);
+		}
+	};
+	vector<thread> workers;
+	for (int t = 1; t < threads; ++t) {
+		workers.push_back(thread(work));
+	}
+	work();
+	for (size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+}
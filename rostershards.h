@@ -0,0 +1,51 @@
+//one DojoManager per location with queries fanned out across all of them.
+//inserts go to a location's shard or, without one, to the name's hash shard
+#pragma once
+#include "DojoManager.h"
+#include "rostergroups.h"
+#include <vector>
+#include <string>
+#include <memory>
+using namespace std;
+
+class rostershards
+{
+public:
+	//where a student lives, shard = -1 if not found
+	struct position {
+		int shard;
+		int index;
+	};
+
+	explicit rostershards(int);
+
+	int shardcount() const;
+	int getsize() const;
+	DojoManager& shard(int);
+	const DojoManager& shard(int) const;
+
+	//returns the shard the student went to
+	int add(StudentInfo*, int location);
+	int add(StudentInfo*);
+	bool remove(const position&);
+	StudentInfo* get(const position&) const;
+
+	//threads = 0 means one per core, never more than one per shard
+	position seqsearch(const string&, int = 0) const;
+	double totalvalue() const;
+	double recomputevalue(int = 0) const;
+	vector<rostergroups::groupstats> groupby(rostergroups::groupkey, int = 0) const;
+	rostergroups::compositegroups groupby(const vector<rostergroups::groupkey>&, int = 0) const;
+
+private:
+	vector<unique_ptr<DojoManager>> shards;
+
+	void checkshard(int) const;
+	void assignid(StudentInfo*) const;
+	//calls fn(shard) once per shard on up to threads workers
+	template <typename Fn>
+	void fanout(int, Fn) const;
+
+	rostershards(const rostershards&);
+	rostershards& operator=(const rostershards&);
+};
@@ -0,0 +1,225 @@
+#include "rostersnapshot.h"
+#include "DojoManager.h"
+#include "dojostudent.h"
+#include "exceptionhandler.h"
+#include "durablefile.h"
+#include <fstream>
+#include <cstring>
+using namespace std;
+
+namespace {
+	const char snapmagic[8] = { 'D', 'O', 'J', 'O', 'S', 'N', 'A', 'P' };
+	const size_t flushsize = 1 << 20;
+
+	static_assert(sizeof(rostersnapshot::fileheader) == 56, "snapshot header layout changed");
+	//version 1 headers stop before nextid
+	const size_t version1header = 48;
+
+	size_t headersize(uint32_t version) {
+		return version == 1 ? version1header : sizeof(rostersnapshot::fileheader);
+	}
+	static_assert(sizeof(rostersnapshot::record) == 32, "snapshot record layout changed");
+
+	void flushbuffer(ofstream& out, string& buffer, const string& path) {
+		out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+		if (!out) {
+			throw exceptionhandler("could not write " + path + " (rostersnapshot::save)");
+		}
+		buffer.clear();
+	}
+}
+
+//written to a temp file next to the real one and swapped in once it's on
+//disk, so a crash part way leaves the previous snapshot as it was
+void rostersnapshot::save(const DojoManager& roster, const string& path)
+{
+	const string temp = path + ".tmp";
+	ofstream out(temp.c_str(), ios::binary | ios::trunc);
+	if (!out) {
+		throw exceptionhandler("could not create " + temp + " (rostersnapshot::save)");
+	}
+
+	const int n = roster.getsize();
+	fileheader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, snapmagic, sizeof(snapmagic));
+	head.version = currentversion;
+	head.recordsize = sizeof(record);
+	head.count = static_cast<uint32_t>(n);
+	head.recordsoffset = sizeof(fileheader);
+	head.stringsoffset = head.recordsoffset + static_cast<uint64_t>(n) * sizeof(record);
+	head.nextid = roster.getnextid();
+
+	//offsets are handed out as the records go, the strings follow in the
+	//same order so the heap is written front to back afterwards
+	uint64_t heap = 0;
+	string buffer;
+	buffer.reserve(flushsize + sizeof(record));
+	buffer.append(reinterpret_cast<const char*>(&head), sizeof(head));
+	for (int i = 0; i < n; ++i) {
+		const StudentInfo* cur = roster.getind(i);
+		record rec;
+		memset(&rec, 0, sizeof(rec));
+		rec.nameoffset = static_cast<uint32_t>(heap);
+		rec.contactoffset = static_cast<uint32_t>(heap);
+		if (cur) {
+			rec.namelength = static_cast<uint32_t>(cur->getName().size());
+			heap += rec.namelength;
+			rec.contactoffset = static_cast<uint32_t>(heap);
+			rec.contactlength = static_cast<uint32_t>(cur->getContact().size());
+			heap += rec.contactlength;
+			rec.age = cur->getAge();
+			rec.months = cur->getMonths();
+			rec.rank = static_cast<uint8_t>(cur->getRank());
+			rec.stripes = static_cast<uint8_t>(cur->getStripes());
+			rec.needsgear = cur->getGear() ? 1 : 0;
+			rec.returning = cur->getReturning() ? 1 : 0;
+			rec.id = cur->getid();
+		}
+		if (heap > 0xFFFFFFFFULL) {
+			throw exceptionhandler("string heap over 4GB (rostersnapshot::save)");
+		}
+		buffer.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+		if (buffer.size() >= flushsize) {
+			flushbuffer(out, buffer, temp);
+		}
+	}
+
+	for (int i = 0; i < n; ++i) {
+		const StudentInfo* cur = roster.getind(i);
+		if (!cur) {
+			continue;
+		}
+		buffer.append(cur->getName());
+		buffer.append(cur->getContact());
+		if (buffer.size() >= flushsize) {
+			flushbuffer(out, buffer, temp);
+		}
+	}
+	flushbuffer(out, buffer, temp);
+
+	//heap size is only known now, patch it into the header
+	head.stringssize = heap;
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+	out.close();
+	if (!out) {
+		throw exceptionhandler("could not write " + temp + " (rostersnapshot::save)");
+	}
+	durablefile::replace(temp, path);
+}
+
+rostersnapshot::rostersnapshot() : file(), header(nullptr), records(nullptr), strings(nullptr)
+{
+}
+
+void rostersnapshot::open(const string& path)
+{
+	close();
+	file.open(path);
+	const char* base = file.data();
+	const size_t length = file.size();
+
+	if (length < version1header || memcmp(base, snapmagic, sizeof(snapmagic)) != 0) {
+		close();
+		throw exceptionhandler(path + " is not a roster snapshot (rostersnapshot::open)");
+	}
+	const fileheader* head = reinterpret_cast<const fileheader*>(base);
+	if (head->version < 1 || head->version > currentversion || head->recordsize != sizeof(record)) {
+		close();
+		throw exceptionhandler(path + " has an unsupported snapshot version (rostersnapshot::open)");
+	}
+	//every size is checked against what's left after its offset, so a
+	//huge offset or count in a damaged header can't wrap around
+	if (length < headersize(head->version) || head->recordsoffset < headersize(head->version)
+		|| head->recordsoffset % alignof(record) != 0) {
+		close();
+		throw exceptionhandler(path + " has a bad records offset (rostersnapshot::open)");
+	}
+	if (head->recordsoffset > length || head->count > (length - head->recordsoffset) / sizeof(record)) {
+		close();
+		throw exceptionhandler(path + " is truncated (rostersnapshot::open)");
+	}
+	const uint64_t recordsend = head->recordsoffset + static_cast<uint64_t>(head->count) * sizeof(record);
+	if (head->stringsoffset < recordsend || head->stringsoffset > length
+		|| head->stringssize > length - head->stringsoffset) {
+		close();
+		throw exceptionhandler(path + " is truncated (rostersnapshot::open)");
+	}
+
+	header = head;
+	records = reinterpret_cast<const record*>(base + head->recordsoffset);
+	strings = base + head->stringsoffset;
+}
+
+void rostersnapshot::close()
+{
+	file.close();
+	header = nullptr;
+	records = nullptr;
+	strings = nullptr;
+}
+
+int rostersnapshot::size() const
+{
+	if (!header) {
+		return 0;
+	}
+	return static_cast<int>(header->count);
+}
+
+const rostersnapshot::record& rostersnapshot::at(int index) const
+{
+	if (index < 0 || index >= size()) {
+		throw exceptionhandler("Index out of bounds (rostersnapshot::at)");
+	}
+	const record& rec = records[index];
+	if (static_cast<uint64_t>(rec.nameoffset) + rec.namelength > header->stringssize
+		|| static_cast<uint64_t>(rec.contactoffset) + rec.contactlength > header->stringssize) {
+		throw exceptionhandler("record points outside the string heap (rostersnapshot::at)");
+	}
+	if (rec.rank > StudentInfo::Black || rec.stripes > StudentInfo::four) {
+		throw exceptionhandler("record has an unknown rank or stripe count (rostersnapshot::at)");
+	}
+	return rec;
+}
+
+const char* rostersnapshot::text(uint32_t offset) const
+{
+	return strings + offset;
+}
+
+string rostersnapshot::name(int index) const
+{
+	const record& rec = at(index);
+	return string(text(rec.nameoffset), rec.namelength);
+}
+
+string rostersnapshot::contact(int index) const
+{
+	const record& rec = at(index);
+	return string(text(rec.contactoffset), rec.contactlength);
+}
+
+uint32_t rostersnapshot::nextid() const
+{
+	if (!header || header->version < 2) {
+		return 0;
+	}
+	return header->nextid;
+}
+
+void rostersnapshot::load(DojoManager& roster) const
+{
+	const int n = size();
+	for (int i = 0; i < n; ++i) {
+		const record& rec = at(i);
+		StudentInfo* cur = new dojostudent(string(text(rec.nameoffset), rec.namelength), rec.age,
+			rec.returning != 0, rec.months, static_cast<StudentInfo::BeltRank>(rec.rank),
+			static_cast<StudentInfo::BeltStripes>(rec.stripes), rec.needsgear != 0,
+			string(text(rec.contactoffset), rec.contactlength));
+		cur->setid(rec.id); //0 from an old save, the roster hands out a new one
+		roster += cur;
+	}
+	roster.reserveids(nextid());
+}
@@ -0,0 +1,72 @@
+//binary roster snapshot: header, fixed size records, then one string heap.
+//records point into the heap by offset so a mapped file is used as is.
+//little endian, written by the same build that reads it
+#pragma once
+#include "mappedfile.h"
+#include <string>
+#include <cstdint>
+using namespace std;
+class DojoManager;
+
+class rostersnapshot
+{
+public:
+	//1 = no nextid in the header, still read. 2 adds nextid
+	static const uint32_t currentversion = 2;
+
+	struct fileheader {
+		char magic[8]; //"DOJOSNAP"
+		uint32_t version;
+		uint32_t recordsize;
+		uint32_t count;
+		uint32_t flags;
+		uint64_t recordsoffset;
+		uint64_t stringsoffset;
+		uint64_t stringssize;
+		uint32_t nextid; //DojoManager::getnextid() at save, version 2 on
+		uint32_t reserved;
+	};
+
+	struct record {
+		uint32_t nameoffset; //into the string heap
+		uint32_t namelength;
+		uint32_t contactoffset;
+		uint32_t contactlength;
+		int32_t age;
+		int32_t months;
+		uint8_t rank;
+		uint8_t stripes;
+		uint8_t needsgear;
+		uint8_t returning;
+		uint32_t id; //StudentInfo::getid()
+	};
+
+	//one pass over the roster, records then strings, big buffered writes.
+	//goes to <path>.tmp first, then is synced and renamed over path
+	static void save(const DojoManager&, const string&);
+
+	rostersnapshot();
+
+	//maps and checks the file, throws exceptionhandler if it isn't a snapshot
+	void open(const string&);
+	void close();
+
+	int size() const;
+	//throws exceptionhandler for a record with out of range strings, rank or stripes
+	const record& at(int) const;
+	const char* text(uint32_t) const;
+	string name(int) const;
+	string contact(int) const;
+	//the roster's next id when it was saved, 0 for a version 1 file
+	uint32_t nextid() const;
+
+	//adds a dojostudent per record to the roster, keeping the saved ids and
+	//never handing out one at or below the saved next id afterwards
+	void load(DojoManager&) const;
+
+private:
+	mappedfile file;
+	const fileheader* header; //only the version 1 fields for a version 1 file
+	const record* records;
+	const char* strings;
+};
@@ -0,0 +1,113 @@
+#include "rosterview.h"
+#include "FinancialSystem.h"
+#include <algorithm>
+using namespace std;
+
+rosterview::rosterview() : snapshot(), nameorder()
+{
+}
+
+void rosterview::open(const string& path)
+{
+	nameorder.clear();
+	snapshot.open(path);
+}
+
+void rosterview::close()
+{
+	nameorder.clear();
+	snapshot.close();
+}
+
+int rosterview::getsize() const
+{
+	return snapshot.size();
+}
+
+string_view rosterview::name(int index) const
+{
+	const rostersnapshot::record& rec = snapshot.at(index);
+	return string_view(snapshot.text(rec.nameoffset), rec.namelength);
+}
+
+string_view rosterview::contact(int index) const
+{
+	const rostersnapshot::record& rec = snapshot.at(index);
+	return string_view(snapshot.text(rec.contactoffset), rec.contactlength);
+}
+
+int rosterview::age(int index) const
+{
+	return snapshot.at(index).age;
+}
+
+int rosterview::months(int index) const
+{
+	return snapshot.at(index).months;
+}
+
+StudentInfo::BeltRank rosterview::rank(int index) const
+{
+	return static_cast<StudentInfo::BeltRank>(snapshot.at(index).rank);
+}
+
+StudentInfo::BeltStripes rosterview::stripes(int index) const
+{
+	return static_cast<StudentInfo::BeltStripes>(snapshot.at(index).stripes);
+}
+
+bool rosterview::needsgear(int index) const
+{
+	return snapshot.at(index).needsgear != 0;
+}
+
+bool rosterview::returning(int index) const
+{
+	return snapshot.at(index).returning != 0;
+}
+
+double rosterview::getvalue(int index) const
+{
+	return FinancialSystem::priceof(age(index), needsgear(index));
+}
+
+int rosterview::seqsearch(string_view wanted) const
+{
+	const int n = getsize();
+	for (int i = 0; i < n; ++i) {
+		if (name(i) == wanted) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int rosterview::binsearch(string_view wanted) const
+{
+	const int n = getsize();
+	if (static_cast<int>(nameorder.size()) != n) {
+		nameorder.resize(n);
+		for (int i = 0; i < n; ++i) {
+			nameorder[i] = static_cast<uint32_t>(i);
+		}
+		stable_sort(nameorder.begin(), nameorder.end(),
+			[this](uint32_t a, uint32_t b) { return name(a) < name(b); });
+	}
+
+	vector<uint32_t>::const_iterator pos = lower_bound(nameorder.begin(), nameorder.end(), wanted,
+		[this](uint32_t a, string_view key) { return name(a) < key; });
+	if (pos != nameorder.end() && name(*pos) == wanted) {
+		return static_cast<int>(*pos);
+	}
+	return -1;
+}
+
+double rosterview::totalvalue() const
+{
+	double total = 0.0;
+	const int n = getsize();
+	for (int i = 0; i < n; ++i) {
+		total += getvalue(i);
+	}
+	return total;
+}
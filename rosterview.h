@@ -0,0 +1,42 @@
+//read only roster straight out of a mapped snapshot. names come back as
+//string_views into the file, nothing is copied or allocated per student
+#pragma once
+#include "StudentInfo.h"
+#include "rostersnapshot.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+class rosterview
+{
+public:
+	rosterview();
+
+	void open(const string&);
+	void close();
+
+	int getsize() const;
+
+	string_view name(int) const;
+	string_view contact(int) const;
+	int age(int) const;
+	int months(int) const;
+	StudentInfo::BeltRank rank(int) const;
+	StudentInfo::BeltStripes stripes(int) const;
+	bool needsgear(int) const;
+	bool returning(int) const;
+	//same price a loaded dojostudent would report
+	double getvalue(int) const;
+
+	//same answers as the DojoManager versions
+	int seqsearch(string_view) const;
+	int binsearch(string_view) const; //builds the name order on first use
+	double totalvalue() const;
+
+private:
+	rostersnapshot snapshot;
+	//record numbers sorted by name, one array for the whole file
+	mutable vector<uint32_t> nameorder;
+};
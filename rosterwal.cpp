@@ -0,0 +1,500 @@
+#include "rosterwal.h"
+#include "exceptionhandler.h"
+#include "mappedfile.h"
+#include "dojostudent.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+
+//file = header, then records. record = uint32 payload length, uint32
+//FNV-1a of the payload, payload. payload = opcode, int32 index, uint32
+//roster next id, then the student or the sort keys
+namespace {
+	const size_t framesize = 8;
+	const char logmagic[8] = { 'D', 'O', 'J', 'O', 'W', 'L', 'O', 'G' };
+	//1 was the headerless log from before ids were logged, it isn't read
+	const uint32_t logversion = 2;
+
+	struct logheader {
+		char magic[8];
+		uint32_t version;
+		uint32_t nextid; //roster's next id when the log was started or reset
+	};
+	static_assert(sizeof(logheader) == 16, "log header layout changed");
+
+	uint32_t checksum(const char* data, size_t n)
+	{
+		uint32_t h = 2166136261u;
+		for (size_t i = 0; i < n; ++i) {
+			h ^= static_cast<unsigned char>(data[i]);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	template <typename T>
+	void put(string& out, T value)
+	{
+		out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void puttext(string& out, const string& text)
+	{
+		put(out, static_cast<uint32_t>(text.size()));
+		out.append(text);
+	}
+
+	//reads walk a payload front to back, any overrun marks it bad
+	struct reader {
+		const char* at;
+		const char* end;
+		bool ok;
+
+		template <typename T>
+		T get()
+		{
+			T value = T();
+			if (static_cast<size_t>(end - at) < sizeof(T)) {
+				ok = false;
+				return value;
+			}
+			memcpy(&value, at, sizeof(T));
+			at += sizeof(T);
+			return value;
+		}
+
+		string gettext()
+		{
+			const uint32_t n = get<uint32_t>();
+			if (!ok || static_cast<size_t>(end - at) < n) {
+				ok = false;
+				return string();
+			}
+			string text(at, n);
+			at += n;
+			return text;
+		}
+	};
+}
+
+rosterwal::rosterwal() : roster(nullptr), path(), fd(-1), lock(), wake(), durable(), pending(),
+	logged(0), synced(0), stopping(false), failed(false), windowms(2), flusher()
+{
+}
+
+rosterwal::~rosterwal()
+{
+	close();
+}
+
+int rosterwal::open(const string& file, DojoManager& target)
+{
+	close();
+	const int replayed = replay(file, target);
+#ifdef _WIN32
+	fd = _open(file.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+	fd = ::open(file.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+	if (fd < 0) {
+		throw exceptionhandler("could not open " + file + " (rosterwal::open)");
+	}
+	path = file;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size == 0) {
+		try {
+			writeheader(target.getnextid());
+		}
+		catch (const exceptionhandler&) {
+#ifdef _WIN32
+			_close(fd);
+#else
+			::close(fd);
+#endif
+			fd = -1;
+			throw;
+		}
+	}
+	roster = &target;
+	logged = 0;
+	synced = 0;
+	stopping = false;
+	failed = false;
+	pending.clear();
+	roster->addlistener(this);
+	flusher = thread(&rosterwal::flushloop, this);
+	return replayed;
+}
+
+void rosterwal::close()
+{
+	if (fd < 0) {
+		return;
+	}
+	if (roster) {
+		roster->removelistener(this);
+	}
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true; //the flusher writes what's left before it exits
+	}
+	wake.notify_one();
+	flusher.join();
+#ifdef _WIN32
+	_close(fd);
+#else
+	::close(fd);
+#endif
+	fd = -1;
+	roster = nullptr;
+}
+
+bool rosterwal::isopen() const
+{
+	return fd >= 0;
+}
+
+void rosterwal::commit()
+{
+	unique_lock<mutex> guard(lock);
+	if (fd < 0) {
+		throw exceptionhandler("log is not open (rosterwal::commit)");
+	}
+	const uint64_t target = logged;
+	wake.notify_one();
+	durable.wait(guard, [this, target]() { return synced >= target || failed; });
+	if (failed) {
+		throw exceptionhandler("could not write " + path + " (rosterwal::commit)");
+	}
+}
+
+void rosterwal::reset()
+{
+	if (fd >= 0 && !roster) {
+		throw exceptionhandler("roster was destroyed (rosterwal::reset)");
+	}
+	commit();
+	lock_guard<mutex> guard(lock);
+#ifdef _WIN32
+	const bool ok = _chsize_s(fd, 0) == 0;
+#else
+	const bool ok = ftruncate(fd, 0) == 0;
+#endif
+	if (!ok) {
+		throw exceptionhandler("could not truncate " + path + " (rosterwal::reset)");
+	}
+	writeheader(roster->getnextid());
+}
+
+void rosterwal::setgroupwindow(int ms)
+{
+	lock_guard<mutex> guard(lock);
+	windowms = ms < 0 ? 0 : ms;
+}
+
+int rosterwal::replay(const string& file, DojoManager& target)
+{
+	struct stat info;
+	if (stat(file.c_str(), &info) != 0) {
+		return 0; //no log yet
+	}
+
+	size_t good = 0;
+	int applied = 0;
+	{
+		mappedfile log;
+		log.open(file);
+		const char* data = log.data();
+		const size_t n = log.size();
+		if (n < sizeof(logheader)) {
+			//empty, or a crash while the header was going out
+			if (memcmp(data, logmagic, n < sizeof(logmagic) ? n : sizeof(logmagic)) != 0) {
+				throw exceptionhandler(file + " is not a roster log (rosterwal::replay)");
+			}
+		}
+		else {
+			logheader head;
+			memcpy(&head, data, sizeof(head));
+			if (memcmp(head.magic, logmagic, sizeof(logmagic)) != 0) {
+				throw exceptionhandler(file + " is not a roster log, or one older than log versions (rosterwal::replay)");
+			}
+			if (head.version != logversion) {
+				throw exceptionhandler(file + " has an unsupported log version " + to_string(head.version) + " (rosterwal::replay)");
+			}
+			target.reserveids(head.nextid);
+			good = sizeof(head);
+		}
+		while (n - good >= framesize) {
+			uint32_t length, sum;
+			memcpy(&length, data + good, 4);
+			memcpy(&sum, data + good + 4, 4);
+			if (n - good - framesize < length || checksum(data + good + framesize, length) != sum) {
+				break; //torn write from a crash, everything before it is fine
+			}
+			if (!apply(data + good + framesize, length, target)) {
+				throw exceptionhandler("log " + file + " doesn't match the roster (rosterwal::replay)");
+			}
+			good += framesize + length;
+			++applied;
+		}
+		if (good == n) {
+			return applied;
+		}
+	}
+
+	//cut the torn tail off so new records don't land behind it
+#ifdef _WIN32
+	int tail = _open(file.c_str(), _O_WRONLY | _O_BINARY);
+	const bool ok = tail >= 0 && _chsize_s(tail, static_cast<long long>(good)) == 0;
+	if (tail >= 0) {
+		_close(tail);
+	}
+#else
+	int tail = ::open(file.c_str(), O_WRONLY);
+	const bool ok = tail >= 0 && ftruncate(tail, static_cast<off_t>(good)) == 0;
+	if (tail >= 0) {
+		::close(tail);
+	}
+#endif
+	if (!ok) {
+		throw exceptionhandler("could not truncate " + file + " (rosterwal::replay)");
+	}
+	return applied;
+}
+
+bool rosterwal::apply(const char* data, size_t n, DojoManager& target)
+{
+	reader in = { data, data + n, true };
+	const uint8_t op = in.get<uint8_t>();
+	const int index = in.get<int32_t>();
+	const uint32_t nextid = in.get<uint32_t>();
+	if (!in.ok) {
+		return false;
+	}
+	//logged after the change, so it's already past an added student's id
+	target.reserveids(nextid);
+
+	if (op == addop || op == changeop) {
+		const string name = in.gettext();
+		const string contact = in.gettext();
+		const int age = in.get<int32_t>();
+		const int months = in.get<int32_t>();
+		const StudentInfo::BeltRank rank = static_cast<StudentInfo::BeltRank>(in.get<uint8_t>());
+		const StudentInfo::BeltStripes stripes = static_cast<StudentInfo::BeltStripes>(in.get<uint8_t>());
+		const bool gear = in.get<uint8_t>() != 0;
+		const bool returning = in.get<uint8_t>() != 0;
+		const uint32_t id = in.get<uint32_t>();
+		if (!in.ok) {
+			return false;
+		}
+		if (op == addop) {
+			if (index != target.getsize()) {
+				return false;
+			}
+			StudentInfo* cur = new dojostudent(name, age, returning, months, rank, stripes, gear, contact);
+			cur->setid(id);
+			target += cur;
+			return true;
+		}
+		if (index < 0 || index >= target.getsize()) {
+			return false;
+		}
+		StudentInfo* cur = target[index];
+		cur->setName(name);
+		cur->setContact(contact);
+		cur->setAge(age);
+		cur->setMonths(months);
+		cur->setRank(rank);
+		cur->setStripes(stripes);
+		cur->setGear(gear);
+		cur->setReturning(returning);
+		return true;
+	}
+	if (op == removeop) {
+		if (index < 0 || index >= target.getsize()) {
+			return false;
+		}
+		target -= index;
+		return true;
+	}
+	if (op == sortop) {
+		studentorder order;
+		for (int i = 0; i < index; ++i) {
+			const studentorder::sortkey key = static_cast<studentorder::sortkey>(in.get<uint8_t>());
+			const bool descending = in.get<uint8_t>() != 0;
+			order.then(key, descending);
+		}
+		if (!in.ok) {
+			return false;
+		}
+		target.sort(order);
+		return true;
+	}
+	if (op == clearop) {
+		target.clear();
+		return true;
+	}
+	return false;
+}
+
+void rosterwal::putstudent(string& out, const StudentInfo* s)
+{
+	puttext(out, s->getName());
+	puttext(out, s->getContact());
+	put(out, static_cast<int32_t>(s->getAge()));
+	put(out, static_cast<int32_t>(s->getMonths()));
+	put(out, static_cast<uint8_t>(s->getRank()));
+	put(out, static_cast<uint8_t>(s->getStripes()));
+	put(out, static_cast<uint8_t>(s->getGear()));
+	put(out, static_cast<uint8_t>(s->getReturning()));
+	put(out, static_cast<uint32_t>(s->getid()));
+}
+
+void rosterwal::startpayload(string& payload, opcode op, int index) const
+{
+	put(payload, static_cast<uint8_t>(op));
+	put(payload, static_cast<int32_t>(index));
+	put(payload, static_cast<uint32_t>(roster->getnextid()));
+}
+
+void rosterwal::append(opcode op, int index, const StudentInfo* s)
+{
+	string payload;
+	startpayload(payload, op, index);
+	if (s) {
+		putstudent(payload, s);
+	}
+	appendrecord(payload);
+}
+
+void rosterwal::appendrecord(const string& payload)
+{
+	lock_guard<mutex> guard(lock);
+	put(pending, static_cast<uint32_t>(payload.size()));
+	put(pending, checksum(payload.data(), payload.size()));
+	pending.append(payload);
+	++logged;
+	wake.notify_one();
+}
+
+//one write + fsync covers every record that arrived during the window
+void rosterwal::flushloop()
+{
+	unique_lock<mutex> guard(lock);
+	while (true) {
+		wake.wait(guard, [this]() { return stopping || !pending.empty(); });
+		if (pending.empty()) {
+			break; //stopping with nothing left
+		}
+		if (windowms > 0 && !stopping) {
+			wake.wait_for(guard, chrono::milliseconds(windowms), [this]() { return stopping; });
+		}
+		string batch;
+		batch.swap(pending);
+		const uint64_t upto = logged;
+
+		guard.unlock();
+		bool ok = true;
+		try {
+			writeall(batch.data(), batch.size());
+			syncfile();
+		}
+		catch (const exceptionhandler&) {
+			ok = false;
+		}
+		guard.lock();
+
+		if (ok) {
+			synced = upto;
+		}
+		else {
+			failed = true;
+		}
+		durable.notify_all();
+	}
+}
+
+void rosterwal::writeall(const char* data, size_t n)
+{
+	while (n > 0) {
+#ifdef _WIN32
+		const int chunk = n > (1u << 30) ? (1 << 30) : static_cast<int>(n);
+		const int written = _write(fd, data, chunk);
+#else
+		const ssize_t written = ::write(fd, data, n);
+#endif
+		if (written <= 0) {
+			throw exceptionhandler("could not write " + path + " (rosterwal)");
+		}
+		data += written;
+		n -= static_cast<size_t>(written);
+	}
+}
+
+//only while the file is empty, at open or right after reset
+void rosterwal::writeheader(unsigned int nextid)
+{
+	logheader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, logmagic, sizeof(logmagic));
+	head.version = logversion;
+	head.nextid = nextid;
+	writeall(reinterpret_cast<const char*>(&head), sizeof(head));
+	syncfile();
+}
+
+void rosterwal::syncfile()
+{
+#ifdef _WIN32
+	const bool ok = _commit(fd) == 0;
+#else
+	const bool ok = fsync(fd) == 0;
+#endif
+	if (!ok) {
+		throw exceptionhandler("could not sync " + path + " (rosterwal)");
+	}
+}
+
+void rosterwal::added(int index, const StudentInfo* s)
+{
+	append(addop, index, s);
+}
+
+void rosterwal::removing(int index, const StudentInfo*)
+{
+	append(removeop, index, nullptr);
+}
+
+void rosterwal::changed(int index, const StudentInfo* s)
+{
+	append(changeop, index, s);
+}
+
+void rosterwal::sorted(const studentorder& order)
+{
+	string payload;
+	startpayload(payload, sortop, order.keycount());
+	for (int i = 0; i < order.keycount(); ++i) {
+		put(payload, static_cast<uint8_t>(order.keyat(i)));
+		put(payload, static_cast<uint8_t>(order.descendingat(i)));
+	}
+	appendrecord(payload);
+}
+
+void rosterwal::cleared()
+{
+	append(clearop, 0, nullptr);
+}
+
+void rosterwal::detached()
+{
+	//the log stays open so what was logged can still be committed
+	roster = nullptr;
+}
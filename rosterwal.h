@@ -0,0 +1,84 @@
+//append-only write-ahead log for a DojoManager. every add, remove, setter
+//change, sort and clear is appended as it happens; a flusher thread batches
+//whatever piled up into one write + fsync (group commit). open() replays the
+//log into the roster first, so after a crash the roster comes back as of
+//the last durable record, next id included. the file starts with a magic
+//and version, logs of another version are refused rather than misread. ex:
+//	rosterwal wal; wal.open("roster.wal", roster);
+//	roster += student; wal.commit(); //returns once the add is on disk
+#pragma once
+#include "DojoManager.h"
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+using namespace std;
+
+class rosterwal : private rosterlistener
+{
+public:
+	rosterwal();
+	~rosterwal();
+
+	//replays path into the roster, then logs every later change to it
+	//returns the number of records replayed
+	int open(const string&, DojoManager&);
+	void close();
+	bool isopen() const;
+
+	//blocks until every change logged so far is durable
+	void commit();
+	//empties the log once the whole roster has been saved somewhere else,
+	//throws exceptionhandler if the roster was destroyed first
+	void reset();
+	//how long the flusher waits for more changes before an fsync, 0 = don't wait
+	void setgroupwindow(int);
+
+	//applies the records in path to the roster, drops a torn tail
+	static int replay(const string&, DojoManager&);
+
+private:
+	enum opcode : uint8_t {
+		addop = 1,
+		removeop,
+		changeop,
+		sortop,
+		clearop
+	};
+
+	DojoManager* roster;
+	string path;
+	int fd; //POSIX descriptor, or a CRT one from _open on windows
+	mutable mutex lock;
+	condition_variable wake; //flusher waits for records
+	condition_variable durable; //commit() waits for the flusher
+	string pending; //records not written yet
+	uint64_t logged; //records appended so far
+	uint64_t synced; //records known to be on disk
+	bool stopping;
+	bool failed;
+	int windowms;
+	thread flusher;
+
+	void startpayload(string&, opcode, int) const;
+	void append(opcode, int, const StudentInfo*);
+	void appendrecord(const string&);
+	void flushloop();
+	void writeall(const char*, size_t);
+	void writeheader(unsigned int);
+	void syncfile();
+
+	static void putstudent(string&, const StudentInfo*);
+	static bool apply(const char*, size_t, DojoManager&);
+
+	virtual void added(int, const StudentInfo*) override;
+	virtual void removing(int, const StudentInfo*) override;
+	virtual void changed(int, const StudentInfo*) override;
+	virtual void sorted(const studentorder&) override;
+	virtual void cleared() override;
+	virtual void detached() override;
+
+	rosterwal(const rosterwal&);
+	rosterwal& operator=(const rosterwal&);
+};
@@ -0,0 +1,112 @@
+#include "studentorder.h"
+#include "StudentInfo.h"
+using namespace std;
+
+namespace {
+	//compare pieces of the names in place so sorting never copies a string
+	void lastword(const string& name, size_t& start, size_t& len) {
+		size_t end = name.find_last_not_of(' ');
+		if (end == string::npos) {
+			start = 0;
+			len = 0;
+			return;
+		}
+		size_t space = name.find_last_of(' ', end);
+		start = (space == string::npos) ? 0 : space + 1;
+		len = end + 1 - start;
+	}
+
+	void firstword(const string& name, size_t& start, size_t& len) {
+		start = name.find_first_not_of(' ');
+		if (start == string::npos) {
+			start = 0;
+			len = 0;
+			return;
+		}
+		size_t space = name.find(' ', start);
+		len = (space == string::npos) ? name.size() - start : space - start;
+	}
+
+	int sign(int v) {
+		return (v > 0) - (v < 0);
+	}
+}
+
+studentorder::studentorder() : keys()
+{
+}
+
+studentorder::studentorder(sortkey key, bool descending) : keys()
+{
+	then(key, descending);
+}
+
+studentorder& studentorder::then(sortkey key, bool descending)
+{
+	keyspec spec;
+	spec.key = key;
+	spec.descending = descending;
+	keys.push_back(spec);
+	return *this;
+}
+
+int studentorder::comparekey(sortkey key, const StudentInfo& a, const StudentInfo& b)
+{
+	size_t astart, alen, bstart, blen;
+	switch (key) {
+	case lastname:
+		lastword(a.getName(), astart, alen);
+		lastword(b.getName(), bstart, blen);
+		return sign(a.getName().compare(astart, alen, b.getName(), bstart, blen));
+	case firstname:
+		firstword(a.getName(), astart, alen);
+		firstword(b.getName(), bstart, blen);
+		return sign(a.getName().compare(astart, alen, b.getName(), bstart, blen));
+	case age:
+		return (a.getAge() > b.getAge()) - (a.getAge() < b.getAge());
+	case rank:
+		return (a.getRank() > b.getRank()) - (a.getRank() < b.getRank());
+	case stripes:
+		return (a.getStripes() > b.getStripes()) - (a.getStripes() < b.getStripes());
+	case months:
+		return (a.getMonths() > b.getMonths()) - (a.getMonths() < b.getMonths());
+	case fullname:
+	default:
+		return sign(a.getName().compare(b.getName()));
+	}
+}
+
+int studentorder::compare(const StudentInfo* a, const StudentInfo* b) const
+{
+	//empty slots sort first, same as the old "" name did
+	if (!a || !b) {
+		return (a != nullptr) - (b != nullptr);
+	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		int result = comparekey(keys[i].key, *a, *b);
+		if (result != 0) {
+			return keys[i].descending ? -result : result;
+		}
+	}
+	return 0;
+}
+
+bool studentorder::operator()(const StudentInfo* a, const StudentInfo* b) const
+{
+	return compare(a, b) < 0;
+}
+
+int studentorder::keycount() const
+{
+	return static_cast<int>(keys.size());
+}
+
+studentorder::sortkey studentorder::keyat(int i) const
+{
+	return keys[i].key;
+}
+
+bool studentorder::descendingat(int i) const
+{
+	return keys[i].descending;
+}
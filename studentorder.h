@@ -0,0 +1,42 @@
+//multi-key ordering used by StudentList::sort and DojoManager::sort
+#pragma once
+#include <string>
+#include <vector>
+using namespace std;
+class StudentInfo;
+
+class studentorder
+{
+public:
+	enum sortkey {
+		fullname,
+		lastname, //last word of the name
+		firstname, //first word of the name
+		age,
+		rank,
+		stripes,
+		months
+	};
+
+	studentorder();
+	studentorder(sortkey, bool = false);
+
+	//adds a tie breaker, ex: studentorder(studentorder::rank, true).then(studentorder::lastname)
+	studentorder& then(sortkey, bool = false);
+
+	int compare(const StudentInfo*, const StudentInfo*) const;
+	bool operator()(const StudentInfo*, const StudentInfo*) const;
+
+	int keycount() const;
+	sortkey keyat(int) const;
+	bool descendingat(int) const;
+
+private:
+	struct keyspec {
+		sortkey key;
+		bool descending;
+	};
+	vector<keyspec> keys;
+
+	static int comparekey(sortkey, const StudentInfo&, const StudentInfo&);
+};
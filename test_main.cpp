@@ -0,0 +1,731 @@
+//doctest cases, built into the DEBUG configuration alongside doctestmain.cpp
+#include "doctest.h"
+#include "DojoManager.h"
+#include "StudentList.h"
+#include "dojostudent.h"
+#include "billingledger.h"
+#include "rosterwal.h"
+#include "rostercheckpoint.h"
+#include "rosterimport.h"
+#include "rosterfilter.h"
+#include "attendance.h"
+#include "eligibility.h"
+#include "enrolldate.h"
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+using namespace std;
+
+//a fresh file name under the temp directory, anything already there is removed
+static string scratchpath(const string& name)
+{
+	const string path = (filesystem::temp_directory_path() / ("dojotest_" + name)).string();
+	filesystem::remove(path);
+	return path;
+}
+
+static dojostudent* benchstudent(int i)
+{
+	return new dojostudent("student" + to_string(i), 10 + i % 50, false, i % 48,
+		StudentInfo::White, StudentInfo::zero, false, "card");
+}
+
+//every field that's persisted, in roster order, so two rosters compare as strings
+static string rosterkey(const DojoManager& roster)
+{
+	string key;
+	for (int i = 0; i < roster.getsize(); ++i) {
+		const StudentInfo* s = roster[i];
+		key += to_string(s->getid()) + ":" + s->getName() + ":" + s->getContact() + ":" + to_string(s->getAge()) + ":" +
+			to_string(s->getMonths()) + ":" + to_string(s->getRank()) + ":" + to_string(s->getStripes()) + ":" +
+			to_string(s->getGear()) + ":" + to_string(s->getReturning()) + ";";
+	}
+	return key;
+}
+
+TEST_CASE("DojoManager::getind at 1k, 100k and 1M entries")
+{
+	const int sizes[] = { 1000, 100000, 1000000 };
+	const int lookups = 1000000;
+
+	for (int s = 0; s < 3; ++s) {
+		int n = sizes[s];
+		DojoManager roster;
+		for (int i = 0; i < n; ++i) {
+			roster += benchstudent(i);
+		}
+
+		//a cheap lcg so the reads jump around the roster instead of streaming
+		unsigned int seed = 12345u;
+		long long agesum = 0;
+		auto start = chrono::steady_clock::now();
+		for (int k = 0; k < lookups; ++k) {
+			seed = seed * 1103515245u + 12345u;
+			agesum += roster.getind(static_cast<int>(seed % static_cast<unsigned int>(n)))->getAge();
+		}
+		auto stop = chrono::steady_clock::now();
+
+		double ns = chrono::duration<double, nano>(stop - start).count() / lookups;
+		MESSAGE("n = " << n << ": " << ns << " ns per getind");
+		CHECK(agesum > 0);
+		CHECK(roster.getind(n - 1)->getName() == "student" + to_string(n - 1));
+	}
+}
+
+TEST_CASE("StudentList keeps order and handles across push_front and remove_at")
+{
+	StudentList list;
+	for (int i = 0; i < 3000; ++i) {
+		list.push_back(benchstudent(i));
+		list.push_front(benchstudent(-1 - i));
+	}
+	REQUIRE(list.size() == 6000);
+	CHECK(list.at(0)->getName() == "student-3000");
+	CHECK(list.at(2999)->getName() == "student-1");
+	CHECK(list.at(3000)->getName() == "student0");
+	CHECK(list.at(5999)->getName() == "student2999");
+
+	StudentList::handle h = list.handleat(4000);
+	list.remove_at(10, true); //closes from the front
+	list.remove_at(5000, true); //closes from the back
+	CHECK(list.indexof(h) == 3999);
+	CHECK(list.get(h)->getName() == "student1000");
+
+	int i = 0;
+	for (StudentList::iterator it = list.begin(); it.hascurrent(); it.next(), ++i) {
+		CHECK(list.at(i) == it.data());
+	}
+	CHECK(i == list.size());
+
+	list.clear(true);
+}
+
+TEST_CASE("StudentList keeps its slot table small under FIFO churn in either direction")
+{
+	StudentList list;
+	const int live = 100;
+	const int churn = 3000000;
+	for (int i = 0; i < live; ++i) {
+		list.push_back(benchstudent(i));
+	}
+	StudentList::handle h = nullptr;
+	for (int i = live; i < live + churn; ++i) {
+		list.push_back(benchstudent(i));
+		list.remove_at(0, true);
+		if (i == live + churn - 50) {
+			h = list.handleat(live - 1); //49 more removals to go
+		}
+	}
+	CHECK(list.size() == live);
+	CHECK(list.capacity() <= 4 * 1024);
+	CHECK(list.at(0)->getName() == "student" + to_string(churn));
+	CHECK(list.at(live - 1)->getName() == "student" + to_string(churn + live - 1));
+	CHECK(list.indexof(h) == live - 1 - 49);
+	CHECK(list.get(h)->getName() == "student" + to_string(churn + 50));
+
+	//the other way: new students at the front, the oldest off the back
+	for (int i = 0; i < churn; ++i) {
+		list.push_front(benchstudent(-1 - i));
+		list.remove_at(list.size() - 1, true);
+	}
+	CHECK(list.size() == live);
+	CHECK(list.capacity() <= 4 * 1024);
+	CHECK(list.at(0)->getName() == "student" + to_string(-churn));
+	CHECK(list.at(live - 1)->getName() == "student" + to_string(-churn + live - 1));
+	int i = 0;
+	for (StudentList::iterator it = list.begin(); it.hascurrent(); it.next(), ++i) {
+		CHECK(list.indexof(list.handleat(i)) == i);
+	}
+	list.clear(true);
+}
+
+TEST_CASE("DojoManager name index stays in step on bulk add, rename and remove")
+{
+	const int n = 200000;
+	DojoManager roster;
+	auto start = chrono::steady_clock::now();
+	for (int i = n - 1; i >= 0; --i) {
+		roster += benchstudent(i);
+	}
+	auto stop = chrono::steady_clock::now();
+	MESSAGE("adding " << n << " students: " << chrono::duration<double, milli>(stop - start).count() << " ms");
+
+	CHECK(roster.binsearch("student0") == n - 1);
+	CHECK(roster.binsearch("student" + to_string(n - 1)) == 0);
+	CHECK(roster.binsearch("nobody") == -1);
+
+	roster.getind(0)->setName("renamed");
+	CHECK(roster.binsearch("student" + to_string(n - 1)) == -1);
+	CHECK(roster.binsearch("renamed") == 0);
+
+	roster -= 0;
+	CHECK(roster.binsearch("renamed") == -1);
+	CHECK(roster.binsearch("student0") == n - 2);
+}
+
+TEST_CASE("DojoManager::binsearch returns the first of duplicate names, like seqsearch")
+{
+	DojoManager roster;
+	for (int i = 0; i < 6; ++i) {
+		roster += new dojostudent(i % 2 ? "twin" : "other" + to_string(i), 10 + i, false, i,
+			StudentInfo::White, StudentInfo::zero, false, "card");
+	}
+	CHECK(roster.binsearch("twin") == 1);
+	CHECK(roster.binsearch("twin") == roster.seqsearch("twin"));
+
+	//oldest twin sorted to the back, the answer follows the roster order
+	roster.sort(studentorder(studentorder::age, true));
+	CHECK(roster.binsearch("twin") == roster.seqsearch("twin"));
+	CHECK(roster[roster.binsearch("twin")]->getAge() == 15);
+	roster -= roster.binsearch("twin");
+	CHECK(roster.binsearch("twin") == roster.seqsearch("twin"));
+	CHECK(roster[roster.binsearch("twin")]->getAge() == 13);
+	CHECK(roster.binsearch("twi") == -1);
+}
+
+TEST_CASE("billingledger answers past months from running balances and saves whole ledgers to new paths")
+{
+	billingledger ledger;
+	ledger.charge(0, 10, 8000);
+	ledger.charge(0, 11, 8000);
+	ledger.pay(0, 11, 8000);
+	ledger.charge(1, 12, 500);
+	ledger.charge(1, 5, 42); //posted out of month order
+	CHECK(ledger.due(0, 10) == 8000);
+	CHECK(ledger.due(0, 11) == 8000);
+	CHECK(ledger.due(1, 4) == 0);
+	CHECK(ledger.due(1, 11) == 42);
+	CHECK(ledger.due(1, 12) == 542);
+	vector<billingledger::owing> owed = ledger.owingfor(11);
+	REQUIRE(owed.size() == 2);
+	CHECK(owed[1].student == 1);
+	CHECK(owed[1].cents == 42);
+
+	const string first = scratchpath("ledger1.bin");
+	const string second = scratchpath("ledger2.bin");
+	ledger.save(first);
+	ledger.pay(1, 12, 542);
+	ledger.save(first); //appends the one new entry
+	ledger.save(second); //a new path gets every entry
+	CHECK(filesystem::file_size(first) == filesystem::file_size(second));
+
+	billingledger other;
+	other.charge(7, 1, 100);
+	other.save(first); //replaces the file, doesn't add to it
+	billingledger loaded;
+	loaded.load(first);
+	CHECK(loaded.size() == 1);
+	loaded.load(second);
+	CHECK(loaded.size() == ledger.size());
+	CHECK(loaded.due(1, 12) == 0);
+
+	//a corrupt student number is refused and the ledger is left as it was
+	{
+		fstream f(second.c_str(), ios::in | ios::out | ios::binary);
+		f.seekp(16);
+		const uint32_t bad = 0xFFFFFFF0u;
+		f.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+	}
+	CHECK_THROWS(loaded.load(second));
+	CHECK(loaded.size() == ledger.size());
+	{
+		ofstream f(first.c_str(), ios::binary | ios::trunc);
+		f << string(24, '\0'); //headerless, from before the header was added
+	}
+	CHECK_THROWS(loaded.load(first));
+}
+
+TEST_CASE("rosterwal replays a logged session and drops a torn tail")
+{
+	const string path = scratchpath("session.wal");
+	string beforelast;
+	uintmax_t goodsize = 0;
+	unsigned int nextid = 0;
+	{
+		DojoManager roster;
+		rosterwal wal;
+		CHECK(wal.open(path, roster) == 0);
+		for (int i = 0; i < 5; ++i) {
+			roster += benchstudent(i);
+		}
+		roster.getind(2)->setName("renamed");
+		roster.getind(3)->setRank(StudentInfo::Green);
+		roster -= 1;
+		roster += benchstudent(5);
+		roster -= roster.getsize() - 1; //the newest id is gone but stays used
+		wal.commit();
+		beforelast = rosterkey(roster);
+		nextid = roster.getnextid();
+		goodsize = filesystem::file_size(path);
+
+		roster += benchstudent(6);
+		wal.commit();
+		wal.close();
+	}
+
+	//a crash part way through the last record
+	filesystem::resize_file(path, filesystem::file_size(path) - 3);
+	DojoManager replayed;
+	CHECK(rosterwal::replay(path, replayed) == 10);
+	CHECK(rosterkey(replayed) == beforelast);
+	CHECK(replayed.getnextid() == nextid);
+	CHECK(filesystem::file_size(path) == goodsize);
+
+	//a reopened log carries on after the cut
+	{
+		DojoManager roster;
+		rosterwal wal;
+		CHECK(wal.open(path, roster) == 10);
+		roster += benchstudent(7);
+		wal.commit();
+		CHECK(roster.getind(roster.getsize() - 1)->getid() == nextid);
+	}
+	DojoManager again;
+	CHECK(rosterwal::replay(path, again) == 11);
+	CHECK(again.getsize() == 5);
+}
+
+TEST_CASE("rosterwal header carries the next id through reset and refuses other versions")
+{
+	const string path = scratchpath("header.wal");
+	unsigned int nextid = 0;
+	{
+		DojoManager roster;
+		rosterwal wal;
+		wal.open(path, roster);
+		for (int i = 0; i < 3; ++i) {
+			roster += benchstudent(i);
+		}
+		roster -= 2;
+		wal.reset(); //as if the roster had just been saved elsewhere
+		nextid = roster.getnextid();
+		CHECK(filesystem::file_size(path) == 16);
+	}
+
+	{
+		ifstream in(path.c_str(), ios::binary);
+		char magic[8];
+		uint32_t version = 0, id = 0;
+		in.read(magic, 8);
+		in.read(reinterpret_cast<char*>(&version), 4);
+		in.read(reinterpret_cast<char*>(&id), 4);
+		CHECK(string(magic, 8) == "DOJOWLOG");
+		CHECK(version == 2);
+		CHECK(id == nextid);
+	}
+	DojoManager replayed;
+	CHECK(rosterwal::replay(path, replayed) == 0);
+	CHECK(replayed.getnextid() == nextid);
+
+	{
+		fstream f(path.c_str(), ios::in | ios::out | ios::binary);
+		f.seekp(8);
+		const uint32_t version = 3;
+		f.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	}
+	DojoManager refused;
+	CHECK_THROWS(rosterwal::replay(path, refused));
+	CHECK(refused.getsize() == 0);
+}
+
+TEST_CASE("rosterwal outlives a roster destroyed before it")
+{
+	const string path = scratchpath("detach.wal");
+	rosterwal wal;
+	{
+		DojoManager roster;
+		wal.open(path, roster);
+		roster += benchstudent(0);
+	}
+	wal.commit(); //what was logged still reaches the disk
+	CHECK_THROWS(wal.reset());
+	wal.close();
+	DojoManager replayed;
+	CHECK(rosterwal::replay(path, replayed) == 1);
+}
+
+TEST_CASE("rostercheckpoint restores base plus deltas, before and after compaction")
+{
+	const string base = scratchpath("checkpoint.snap");
+	for (int d = 1; d <= 4; ++d) {
+		filesystem::remove(base + ".delta." + to_string(d));
+	}
+	string expected;
+	unsigned int nextid = 0;
+	{
+		DojoManager roster;
+		rostercheckpoint cp;
+		cp.open(base, roster);
+		for (int i = 0; i < 5; ++i) {
+			roster += benchstudent(i);
+		}
+		CHECK(cp.checkpoint() == 5);
+		roster.getind(2)->setName("renamed");
+		roster -= 1;
+		roster += benchstudent(5);
+		CHECK(cp.checkpoint() == 3);
+		expected = rosterkey(roster);
+		nextid = roster.getnextid();
+	}
+	CHECK(filesystem::exists(base + ".delta.2"));
+
+	{
+		DojoManager restored;
+		rostercheckpoint cp;
+		cp.open(base, restored);
+		CHECK(rosterkey(restored) == expected);
+		CHECK(restored.getnextid() == nextid);
+		cp.startcompaction();
+		cp.waitcompaction();
+	}
+	CHECK(filesystem::exists(base));
+	CHECK(!filesystem::exists(base + ".delta.1"));
+	CHECK(!filesystem::exists(base + ".delta.2"));
+
+	DojoManager compacted;
+	rostercheckpoint cp;
+	cp.open(base, compacted);
+	CHECK(rosterkey(compacted) == expected);
+	CHECK(compacted.getnextid() == nextid);
+}
+
+TEST_CASE("rostercheckpoint survives a crash between the new base and the delta deletes")
+{
+	const string base = scratchpath("crash.snap");
+	for (int d = 1; d <= 4; ++d) {
+		filesystem::remove(base + ".delta." + to_string(d));
+	}
+	string expected;
+	{
+		DojoManager roster;
+		rostercheckpoint cp;
+		cp.open(base, roster);
+		for (int i = 0; i < 4; ++i) {
+			roster += benchstudent(i);
+		}
+		cp.checkpoint();
+		roster.getind(0)->setAge(77);
+		roster -= 3; //its tombstone outlives the student in the new base
+		cp.checkpoint();
+		expected = rosterkey(roster);
+
+		//keep the deltas, compact, then put them back as a crash would have
+		//left them: the new base in place, none of the deltas deleted yet
+		filesystem::copy_file(base + ".delta.1", base + ".keep.1");
+		filesystem::copy_file(base + ".delta.2", base + ".keep.2");
+		cp.startcompaction();
+		cp.waitcompaction();
+		filesystem::rename(base + ".keep.1", base + ".delta.1");
+		filesystem::rename(base + ".keep.2", base + ".delta.2");
+		//and a base.tmp from a compaction that died before its rename
+		ofstream(base + ".tmp", ios::binary) << "torn";
+	}
+
+	DojoManager restored;
+	rostercheckpoint cp;
+	cp.open(base, restored);
+	CHECK(rosterkey(restored) == expected);
+	restored += benchstudent(9);
+	CHECK(cp.checkpoint() == 1);
+	CHECK(filesystem::exists(base + ".delta.3"));
+	cp.startcompaction();
+	cp.waitcompaction();
+	CHECK(!filesystem::exists(base + ".delta.1"));
+	CHECK(!filesystem::exists(base + ".delta.3"));
+	expected = rosterkey(restored);
+	cp.close();
+
+	DojoManager again;
+	rostercheckpoint reopened;
+	reopened.open(base, again);
+	CHECK(rosterkey(again) == expected);
+	filesystem::remove(base + ".tmp");
+}
+
+TEST_CASE("rosterimport reads lines cut by chunk boundaries and one longer than a chunk")
+{
+	const string path = scratchpath("import.csv");
+	const int n = 30000; //about 1.5 MB, so lines straddle the 1 MB reads
+	const string longcontact(1500000, 'c');
+	{
+		ofstream out(path.c_str(), ios::binary);
+		out << "name,age,returning,months,rank,stripes,needsgear,contact\r\n";
+		for (int i = 0; i < n; ++i) {
+			out << "student" << i << "," << 10 + i % 50 << ",no," << i % 48 << ",White,zero,0,parent of " << i << "\r\n";
+		}
+		out << "long," << 30 << ",1,5,Blue,two,yes," << longcontact << "\n";
+		out << "last,40,0,0,Black,four,0,x"; //no newline at the end
+	}
+	DojoManager roster;
+	rosterimport importer;
+	rosterimport::result res = importer.importfile(path, roster);
+	CHECK(res.imported == n + 2);
+	CHECK(res.rejected == 0);
+	REQUIRE(roster.getsize() == n + 2);
+	for (int i = 0; i < n; i += 997) {
+		CHECK(roster[i]->getName() == "student" + to_string(i));
+		CHECK(roster[i]->getContact() == "parent of " + to_string(i));
+	}
+	CHECK(roster[n]->getContact() == longcontact);
+	CHECK(roster[n]->getRank() == StudentInfo::Blue);
+	CHECK(roster[n + 1]->getName() == "last");
+	CHECK(roster[n + 1]->getStripes() == StudentInfo::four);
+}
+
+TEST_CASE("rosterimport CSV quoting and malformed rows")
+{
+	rosterimport importer(rosterimport::csv);
+	StudentInfo::StudentInf s;
+	string error;
+	REQUIRE(importer.parseline("\"Smith, John\",12,yes,3,Green,one,false,\"says \"\"hi\"\"\"", s, error));
+	CHECK(s.name == "Smith, John");
+	CHECK(s.age == 12);
+	CHECK(s.isReturning);
+	CHECK(s.rank == StudentInfo::Green);
+	CHECK(s.stripes == StudentInfo::one);
+	CHECK(s.Contact == "says \"hi\"");
+
+	CHECK(!importer.parseline("\"Smith, John,12,yes,3,Green,one,false,x", s, error));
+	CHECK(error.find("unclosed quote") != string::npos);
+	CHECK(!importer.parseline("a,12,yes,3,Green,one,false", s, error)); //7 columns
+	CHECK(!importer.parseline("a,12,yes,3,Green,one,false,x,extra", s, error));
+	CHECK(!importer.parseline("a,twelve,yes,3,Green,one,false,x", s, error));
+	CHECK(!importer.parseline("a,12,maybe,3,Green,one,false,x", s, error));
+	CHECK(!importer.parseline("a,12,yes,3,Plaid,one,false,x", s, error));
+	CHECK(!importer.parseline("a,12,yes,3,9,one,false,x", s, error));
+	CHECK(!importer.parseline("a,3,yes,3,Green,one,false,x", s, error)); //too young
+	CHECK(!importer.parseline(",12,yes,3,Green,one,false,x", s, error));
+}
+
+TEST_CASE("rosterimport JSON skips nested values under unknown keys and rejects bad lines")
+{
+	rosterimport importer(rosterimport::ndjson);
+	StudentInfo::StudentInf s;
+	string error;
+	REQUIRE(importer.parseline("{\"name\":\"A\",\"extra\":{\"k\":[1,\"}],\",{}]},\"age\":12,\"months\":2,"
+		"\"rank\":\"Blue\",\"tags\":[],\"contact\":\"B\\u00e9\"}  ", s, error));
+	CHECK(s.name == "A");
+	CHECK(s.age == 12);
+	CHECK(s.rank == StudentInfo::Blue);
+	CHECK(s.Contact == "B\xC3\xA9");
+
+	CHECK(!importer.parseline("{\"name\":{\"first\":\"A\"},\"age\":12,\"contact\":\"B\"}", s, error));
+	CHECK(error.find("plain value") != string::npos);
+	CHECK(!importer.parseline("{\"name\":\"A\",\"x\":{\"k\":[1}},\"age\":12,\"contact\":\"B\"}", s, error));
+	CHECK(!importer.parseline("{\"name\":\"A\",\"age\":12,\"contact\":\"B\"} trailing", s, error));
+	CHECK(error.find("after the closing") != string::npos);
+	CHECK(!importer.parseline("{\"name\":\"A\",\"age\":12,\"contact\":\"B\"}{}", s, error));
+	CHECK(!importer.parseline("{\"name\" \"A\",\"age\":12,\"contact\":\"B\"}", s, error));
+	CHECK(!importer.parseline("{\"name\":\"A\",\"age\":12,\"contact\":\"B\"", s, error));
+	CHECK(!importer.parseline("{\"age\":12,\"contact\":\"B\"}", s, error));
+	CHECK(error == "missing name");
+	CHECK(!importer.parseline("[\"A\",12]", s, error));
+}
+
+TEST_CASE("rosterfilter kernels agree with a plain loop on odd lengths and tail bits")
+{
+	const int sizes[] = { 0, 1, 31, 63, 64, 65, 127, 128, 129, 1000, 1031 };
+	const int32_t edges[] = { numeric_limits<int32_t>::min(), -1, 0, 6, 17, 18, 90, numeric_limits<int32_t>::max() };
+	vector<int32_t> ints(1031);
+	vector<uint8_t> bytes(1031);
+	unsigned int seed = 777u;
+	for (size_t i = 0; i < ints.size(); ++i) {
+		seed = seed * 1103515245u + 12345u;
+		ints[i] = (seed >> 8) % 4 == 0 ? edges[(seed >> 12) % 8] : static_cast<int32_t>((seed >> 16) % 100);
+		bytes[i] = static_cast<uint8_t>((seed >> 20) % 4 == 0 ? 0xFF : (seed >> 24) % 7);
+	}
+
+	const rosterfilter::kernel best = rosterfilter::usekernel(rosterfilter::scalarkernel);
+	const rosterfilter::kernel kernels[] = { rosterfilter::scalarkernel, rosterfilter::sse2kernel, rosterfilter::avx2kernel };
+	for (int k = 0; k < 3; ++k) {
+		if (!rosterfilter::haskernel(kernels[k])) {
+			MESSAGE("kernel " << k << " isn't in this build");
+			continue;
+		}
+		rosterfilter::usekernel(kernels[k]);
+		for (int n : sizes) {
+			for (int b = 0; b < 8; ++b) {
+				const int32_t lo = edges[b];
+				const int32_t hi = edges[(b + 3) % 8];
+				const uint8_t wanted = static_cast<uint8_t>(b == 7 ? 0xFF : b);
+				rosterfilter::bitmap range((n + 63) / 64, 0), equal((n + 63) / 64, 0), truth((n + 63) / 64, 0);
+				for (int i = 0; i < n; ++i) {
+					range[i / 64] |= static_cast<uint64_t>(ints[i] >= lo && ints[i] <= hi) << (i % 64);
+					equal[i / 64] |= static_cast<uint64_t>(bytes[i] == wanted) << (i % 64);
+					truth[i / 64] |= static_cast<uint64_t>(bytes[i] != 0) << (i % 64);
+				}
+				CAPTURE(k);
+				CAPTURE(n);
+				CAPTURE(b);
+				CHECK(rosterfilter::inrange(ints.data(), n, lo, hi) == range);
+				CHECK(rosterfilter::equals(bytes.data(), n, wanted) == equal);
+				CHECK(rosterfilter::istrue(bytes.data(), n) == truth);
+				CHECK(rosterfilter::countinrange(ints.data(), n, lo, hi) == rosterfilter::count(range));
+				CHECK(rosterfilter::countequals(bytes.data(), n, wanted) == rosterfilter::count(equal));
+				CHECK(rosterfilter::counttrue(bytes.data(), n) == rosterfilter::count(truth));
+			}
+		}
+	}
+	rosterfilter::usekernel(best);
+}
+
+TEST_CASE("attendance counts across word boundaries and clips to the window")
+{
+	const int32_t start = 20000;
+	attendance log(start, 200);
+	for (int d = 0; d < 200; d += 3) {
+		log.checkin(7, start + d);
+	}
+	//the plain count of every third day in [lo, hi]
+	auto expected = [](int lo, int hi) {
+		int n = 0;
+		for (int d = lo; d <= hi; ++d) {
+			n += (d % 3 == 0);
+		}
+		return n;
+	};
+	const int spans[][2] = { { 3, 40 }, { 0, 63 }, { 63, 64 }, { 64, 127 }, { 60, 130 }, { 1, 199 }, { 5, 5 }, { 6, 6 } };
+	for (const auto& span : spans) {
+		CAPTURE(span[0]);
+		CAPTURE(span[1]);
+		CHECK(log.count(7, start + span[0], start + span[1]) == expected(span[0], span[1]));
+	}
+	CHECK(log.count(7, start + 10, start + 9) == 0);
+	CHECK(log.count(8, start, start + 199) == 0);
+
+	//ranges hanging off either end only count the days inside the window
+	CHECK(log.count(7, start - 50, start + 199 + 50) == expected(0, 199));
+	CHECK(log.recent(7, start + 9, 30) == expected(0, 9));
+	CHECK(log.recent(7, start + 250, 100) == expected(151, 199));
+	CHECK(log.recent(7, start - 1, 10) == 0);
+	uint32_t ids[] = { 7, 8, 100000 };
+	int out[3];
+	log.counts(ids, 3, start - 5, start + 70, out);
+	CHECK(out[0] == expected(0, 70));
+	CHECK(out[1] == 0);
+	CHECK(out[2] == 0);
+
+	CHECK_THROWS(log.checkin(7, start + 200));
+	CHECK_THROWS(log.checkin(0xFFFFFFFFu, start));
+	CHECK(log.rowcount() == 8);
+}
+
+TEST_CASE("attendance saves through a temp file and checks sizes before loading")
+{
+	const string path = scratchpath("attendance.bin");
+	attendance log(1000, 100);
+	log.checkin(3, 1000);
+	log.checkin(3, 1099);
+	log.checkin(5, 1050);
+	log.save(path);
+	CHECK(!filesystem::exists(path + ".tmp"));
+
+	attendance loaded(0, 1);
+	loaded.load(path);
+	CHECK(loaded.firstday() == 1000);
+	CHECK(loaded.lastday() == 1099);
+	CHECK(loaded.rowcount() == 6);
+	CHECK(loaded.attended(3, 1099));
+	CHECK(loaded.count(5, 0, 5000) == 1);
+
+	//a header claiming far more rows than the file holds
+	{
+		fstream f(path.c_str(), ios::in | ios::out | ios::binary);
+		f.seekp(20);
+		const uint32_t rows = 1000000;
+		f.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+	}
+	CHECK_THROWS(loaded.load(path));
+	CHECK(loaded.rowcount() == 6);
+	log.save(path);
+	filesystem::resize_file(path, filesystem::file_size(path) - 8);
+	CHECK_THROWS(loaded.load(path));
+	CHECK(loaded.attended(3, 1000));
+}
+
+TEST_CASE("eligibility orders by readiness and skips ranks it has no slot for")
+{
+	const int32_t today = 30000;
+	struct row {
+		const char* name;
+		int months;
+		int rank;
+		int stripes;
+		int sessions;
+	};
+	//(White, zero) steps up at 2 months, (Yellow, zero) at 8, (Brown, four) at 42
+	const row rows[] = {
+		{ "a", 4, StudentInfo::White, StudentInfo::zero, 48 }, //2.0
+		{ "b", 8, StudentInfo::Yellow, StudentInfo::zero, 30 }, //1.0
+		{ "c", 8, StudentInfo::Yellow, StudentInfo::zero, 40 }, //1.0, after b
+		{ "d", 4, StudentInfo::White, StudentInfo::zero, 36 }, //1.5
+		{ "e", 4, StudentInfo::White, StudentInfo::zero, 10 }, //too few classes
+		{ "f", 100, StudentInfo::Black, StudentInfo::zero, 50 }, //nothing above black
+		{ "g", 100, 200, StudentInfo::zero, 50 }, //bytes no BeltRank holds
+		{ "h", 100, StudentInfo::Green, -1, 50 },
+		{ "i", 41, StudentInfo::Brown, StudentInfo::four, 50 }, //a month short
+		{ "j", 42, StudentInfo::Brown, StudentInfo::four, 24 }, //1.0
+	};
+	DojoManager roster;
+	attendance log(today - 200, 400);
+	for (const row& r : rows) {
+		roster += new dojostudent(r.name, 20, false, r.months, static_cast<StudentInfo::BeltRank>(r.rank),
+			static_cast<StudentInfo::BeltStripes>(r.stripes), false, "card");
+		const uint32_t id = roster[roster.getsize() - 1]->getid();
+		for (int d = 0; d < r.sessions; ++d) {
+			log.checkin(id, today - d);
+		}
+		log.checkin(id, today - 120); //outside the 90 day window
+	}
+
+	eligibility rules;
+	CHECK(rules.requirementfor(StudentInfo::White, StudentInfo::zero).minmonths == 2);
+	CHECK(rules.requirementfor(StudentInfo::Yellow, StudentInfo::zero).minmonths == 8);
+	CHECK(rules.requirementfor(StudentInfo::Brown, StudentInfo::four).minmonths == 42);
+	CHECK(rules.requirementfor(StudentInfo::Black, StudentInfo::zero).minmonths < 0);
+
+	const vector<eligibility::candidate> picks = rules.evaluate(roster, log, today);
+	string order;
+	for (const eligibility::candidate& c : picks) {
+		order += roster[c.index]->getName();
+		CHECK(c.id == roster[c.index]->getid());
+	}
+	CHECK(order == "adbcj");
+	REQUIRE(picks.size() == 5);
+	CHECK(picks[0].readiness == doctest::Approx(2.0));
+	CHECK(picks[0].sessions == 48);
+	CHECK(picks[1].readiness == doctest::Approx(1.5));
+	CHECK(picks[4].rank == StudentInfo::Brown);
+	CHECK(picks[4].stripes == StudentInfo::four);
+
+	//a longer window brings the old check-in in, a stricter rule drops b and c
+	rules.setwindow(150);
+	rules.requiresessions(StudentInfo::Yellow, 42);
+	CHECK(rules.evaluate(roster, log, today).size() == 3);
+	CHECK(rules.evaluate(roster, log, today)[0].sessions == 49);
+}
+
+TEST_CASE("DojoManager::refreshmonths works months out from start days in one pass")
+{
+	DojoManager roster;
+	for (int i = 0; i < 5000; ++i) {
+		roster += benchstudent(i);
+		roster[i]->setStartDay(enrolldate::fromcivil(2020 + i % 6, 1 + i % 12, 1 + i % 28));
+	}
+	roster += benchstudent(5000); //no start day, keeps its months
+	const int kept = roster[5000]->getMonths();
+
+	const int32_t now = enrolldate::fromcivil(2026, 3, 15);
+	CHECK(roster.refreshmonths(now) > 0);
+	for (int i = 0; i < 5000; i += 37) {
+		CAPTURE(i);
+		CHECK(roster[i]->getMonths() == enrolldate::monthsbetween(roster[i]->getStartDay(), now));
+	}
+	CHECK(roster[5000]->getMonths() == kept);
+	CHECK(roster.refreshmonths(now) == 0); //nothing left to change
+
+	//a month later every dated student moves on by one
+	CHECK(roster.refreshmonths(enrolldate::fromcivil(2026, 4, 1)) == 5000);
+}